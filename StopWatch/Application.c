@@ -6,208 +6,853 @@
  */
 
 #include "Application.h"
+#include "Clock.h"
 
-/// Global stopwatch time variable
-Time g_SevenSeg_time = { 3, 59,46 };
+/// Global stopwatch time variable, rendered from the stopwatch value by StopWatch_Refresh()
+volatile Time g_SevenSeg_time = { 0x03, 0x59, 0x46 };
 
 /// Global mode flag: INCREMENTAL_MODE or DECREMENTAL_MODE
 volatile uint8 g_mode = INCREMENTAL_MODE;
 
 /// Global stopwatch mode
-StopWatchMode CurrentMode = RESUME;
+volatile StopWatchMode CurrentMode = RESUME;
 
 /// Array of SevenSegment display instances (HH:MM:SS)
 SevenSegment g_Mult_SevenSegment[NUM_SEVEN_SEGMENTS];
 
+/// Running up: instant at which the value was 0. Running down: instant at which it reaches 0.
+static TimeStamp Origin;
+
+/// Value held while paused, including the fraction of a tick
+static TimeStamp Frozen;
+
+/// Hundredths of a second currently shown in g_SevenSeg_time
+static uint32 RenderedHundredths;
+
+/// Capture that started the current photogate run
+static TimeStamp GateStart;
+
+/// TRUE while a run started by the photogate is in progress
+static uint8 GateRunning = FALSE;
+
+/// Last photogate interval in CPU cycles
+static uint32 GateCycles;
+
+/// Lap shown instead of the live value: 0 for none, n for the lap n - 1 splits back
+static uint8 Recall = 0;
+
+/// TRUE while the digits show the time of day
+static uint8 ClockShown = FALSE;
+
+/// Display interrupts until INT0, INT1 and INT2 are re-armed; 0 while armed
+static uint8 ResetLockout = 0;
+static uint8 PauseLockout = 0;
+static uint8 ResumeLockout = 0;
+
 /**
  * @brief External interrupt 0 ISR.
- * Resets time and mode.
+ * Queues a reset request and disarms INT0 until the key is released.
  */
 ISR(INT0_vect)
 {
-	g_SevenSeg_time.Hour = 0;
-	g_SevenSeg_time.Min = 0;
-	g_SevenSeg_time.Sec = 0;
-	g_mode = INCREMENTAL_MODE;
+	CLEAR(GICR, INT0);
+	ResetLockout = KEY_LOCKOUT_DIGITS;
+	EventQueue_Push(EVENT_RESET, 0);
 }
 
 /**
  * @brief External interrupt 1 ISR.
- * Pauses stopwatch by turning off Timer1.
+ * Queues a pause request and disarms INT1 until the key is released.
  */
 ISR(INT1_vect)
 {
-	Timer1_OFF();
-	CurrentMode = PAUSED;
+	CLEAR(GICR, INT1);
+	PauseLockout = KEY_LOCKOUT_DIGITS;
+	EventQueue_Push(EVENT_PAUSE, 0);
 }
 
 /**
  * @brief External interrupt 2 ISR.
- * Resumes stopwatch by turning on Timer1.
+ * Queues a resume request and disarms INT2 until the key is released.
  */
 ISR(INT2_vect)
 {
-	Timer1_ON();
-	CurrentMode = RESUME;
+	CLEAR(GICR, INT2);
+	ResumeLockout = KEY_LOCKOUT_DIGITS;
+	EventQueue_Push(EVENT_RESUME, 0);
 }
 
 /**
- * @brief Timer1 Compare Match A ISR.
- * Increments or decrements seconds depending on mode.
+ * @brief Counts down the lockout of a disarmed interrupt key (display ISR).
+ *
+ * The count restarts while the key is held; when it runs out, the edge
+ * latched by the bounce is discarded and the interrupt enabled again.
+ *
+ * @param lockout Remaining count, not 0.
+ * @param level Key level (PRESSED or RELEASED).
+ * @param enableBit INTn bit in GICR.
+ * @param flagBit INTFn bit in GIFR.
+ * @return uint8 New remaining count, 0 once re-armed.
  */
-ISR(TIMER1_COMPA_vect)
+static ALWAYS_INLINE uint8 KeyLockout(uint8 lockout, uint8 level, uint8 enableBit, uint8 flagBit)
 {
-	if (g_mode == INCREMENTAL_MODE)
+	if (level == PRESSED)
 	{
-		IncSec();
+		return KEY_LOCKOUT_DIGITS;
 	}
-	else // DECREMENTAL_MODE
+	if (--lockout == 0)
 	{
-		DecSec();
+		GIFR = (1 << flagBit);  // plain write: SET would also clear the other pending flags
+		SET(GICR, enableBit);
 	}
+	return lockout;
 }
 
 /**
- * @brief Refreshes the seven segment display with the current time.
+ * @brief result = a + b, carrying the timer counts into ticks.
  */
-void SevenSegmentUpdate()
+static void StampAdd(const TimeStamp* a, const TimeStamp* b, TimeStamp* result)
 {
-	uint8* ptr_to_time = (uint8*)&g_SevenSeg_time;
-	for(int i = 0; i < NUM_SEVEN_SEGMENTS; i++)
+	uint16 counts = a->counts + b->counts;
+	Ticks ticks = a->ticks + b->ticks;
+
+	if (counts >= TIMEBASE_COUNTS)
 	{
-		// Select current digit
-		SET(SEVEN_SEGMENT_MULT_PORT, i);
+		counts -= TIMEBASE_COUNTS;
+		ticks++;
+	}
+	result->ticks = ticks;
+	result->counts = counts;
+}
+
+/**
+ * @brief result = a - b, borrowing a tick when the counts underflow.
+ */
+static void StampSub(const TimeStamp* a, const TimeStamp* b, TimeStamp* result)
+{
+	Ticks ticks = a->ticks - b->ticks;
+	uint16 counts = a->counts;
+
+	if (counts < b->counts)
+	{
+		counts += TIMEBASE_COUNTS;
+		ticks--;
+	}
+	result->ticks = ticks;
+	result->counts = counts - b->counts;
+}
 
-		if (i & 1) // odd: units digit
+/**
+ * @brief Computes the exact stopwatch value from the timestamps.
+ *
+ * Counting up saturates at STOPWATCH_MAX_TICKS and counting down at 0.
+ *
+ * @param now Current instant.
+ * @param value Pointer to the value to fill (whole ticks plus timer counts).
+ */
+static void ExactValue(const TimeStamp* now, TimeStamp* value)
+{
+	if (CurrentMode == PAUSED)
+	{
+		*value = Frozen;
+	}
+	else if (g_mode == INCREMENTAL_MODE)
+	{
+		StampSub(now, &Origin, value);
+		if (value->ticks >= STOPWATCH_MAX_TICKS)
 		{
-			WriteSevenSegment(&g_Mult_SevenSegment[i], (*ptr_to_time) % 10);
-			ptr_to_time++;
+			value->ticks = STOPWATCH_MAX_TICKS;
+			value->counts = 0;
 		}
-		else // even: tens digit
+	}
+	else // DECREMENTAL_MODE: a deadline in the past reads as 0
+	{
+		StampSub(&Origin, now, value);
+		if ((int32)value->ticks < 0)
 		{
-			WriteSevenSegment(&g_Mult_SevenSegment[i], (*ptr_to_time) / 10);
+			value->ticks = 0;
+			value->counts = 0;
 		}
+	}
+}
 
-		_delay_ms(1);
+/**
+ * @brief Computes the stopwatch value in whole ticks.
+ *
+ * Counting up rounds down and counting down rounds up, so a countdown
+ * reads 0 exactly at its deadline.
+ *
+ * @param now Current instant.
+ * @return Ticks Stopwatch value in ticks.
+ */
+static Ticks CurrentValue(const TimeStamp* now)
+{
+	TimeStamp value;
+	ExactValue(now, &value);
 
-		// Clear all digit selections
-		CLEAR_REG(SEVEN_SEGMENT_MULT_PORT, SEVEN_SEGMENT_MULT_PIN);
+	if (g_mode == DECREMENTAL_MODE && value.counts != 0)
+	{
+		return value.ticks + 1;
 	}
+	return value.ticks;
 }
 
 /**
- * @brief Updates LEDs based on current stopwatch mode.
- * @param countUp Pointer to count-up mode LED.
- * @param countDown Pointer to count-down mode LED.
+ * @brief Re-anchors the timestamps so that the value is @p value at @p now.
+ *
+ * Atomic, like every change of the state, because the power-fail interrupt
+ * reads it with StopWatch_GetState().
+ *
+ * @param value New exact stopwatch value (0 to STOPWATCH_MAX_TICKS).
+ * @param now Current instant.
  */
-void UpdateCountLEDs(Led* countUp, Led* countDown)
+static void SetValue(const TimeStamp* value, const TimeStamp* now)
 {
-    if (g_mode == INCREMENTAL_MODE)
-    {
-        TurnOnLed(countUp);
-        TurnOffLed(countDown);
-    }
-    else
-    {
-        TurnOnLed(countDown);
-        TurnOffLed(countUp);
-    }
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (CurrentMode == PAUSED)
+		{
+			Frozen = *value;
+		}
+		else if (g_mode == INCREMENTAL_MODE)
+		{
+			StampSub(now, value, &Origin);
+		}
+		else // DECREMENTAL_MODE
+		{
+			StampAdd(now, value, &Origin);
+		}
+	}
 }
 
 /**
- * @brief Increments the hour value.
+ * @brief Sets a whole-tick value at the current instant.
+ *
+ * @param ticks New stopwatch value in ticks.
  */
-void IncHour()
+static void SetTicks(Ticks ticks)
 {
-	if (g_SevenSeg_time.Hour == 99)
+	TimeStamp now;
+	TimeStamp value = { ticks, 0 };
+
+	TimeBase_Stamp(&now);
+	SetValue(&value, &now);
+}
+
+/**
+ * @brief Goes back to showing the live value.
+ */
+static void EndRecall()
+{
+	if (Recall)
+	{
+		Recall = 0;
+		RenderedHundredths = 0xFFFFFFFF;
+	}
+}
+
+/**
+ * @brief Restarts the lap memory and the lap log from a new value.
+ *
+ * Called whenever the value is set or the direction changes, so the first
+ * lap runs from where the stopwatch really starts.
+ *
+ * @param start Stopwatch value in ticks.
+ */
+static void RestartLaps(Ticks start)
+{
+	Lap_Clear(start);
+	LapLog_Begin(start);
+	EndRecall();
+}
+
+/**
+ * @brief Adds a signed amount to the value, saturating at 0 and STOPWATCH_MAX_TICKS.
+ *
+ * The fraction of a tick is kept, so adjusting a running stopwatch does not
+ * shift its phase.
+ *
+ * @param delta Amount in ticks.
+ */
+static void AdjustValue(int32 delta)
+{
+	TimeStamp now;
+	TimeStamp value;
+
+	TimeBase_Stamp(&now);
+	ExactValue(&now, &value);
+
+	if (delta >= 0)
+	{
+		if ((Ticks)delta >= STOPWATCH_MAX_TICKS - value.ticks)
+		{
+			value.ticks = STOPWATCH_MAX_TICKS;
+			value.counts = 0;
+		}
+		else
+		{
+			value.ticks += delta;
+		}
+	}
+	else if ((Ticks)-delta > value.ticks)
 	{
-		g_SevenSeg_time.Hour = 99;
-		g_SevenSeg_time.Min = 59;
-		g_SevenSeg_time.Sec = 59;
+		value.ticks = 0;
+		value.counts = 0;
 	}
 	else
 	{
-		g_SevenSeg_time.Hour++;
+		value.ticks += delta;
 	}
+	SetValue(&value, &now);
+	RestartLaps(value.ticks);
 }
 
 /**
- * @brief Decrements the hour value.
+ * @brief Freezes the value as it was at @p now.
+ *
+ * @param now Instant of the pause request.
  */
-void DecHour()
+static void Pause(const TimeStamp* now)
 {
-	if (g_SevenSeg_time.Hour == 0)
+	if (CurrentMode != PAUSED)
 	{
-		g_SevenSeg_time.Hour = 0;
-		g_SevenSeg_time.Min = 0;
-		g_SevenSeg_time.Sec = 0;
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			ExactValue(now, &Frozen);
+			CurrentMode = PAUSED;
+		}
 	}
-	else
+}
+
+/**
+ * @brief Continues from the frozen value, counting from @p now.
+ *
+ * The frozen fraction of a tick is carried over, so any number of
+ * pause/resume cycles adds no error.
+ *
+ * @param now Instant of the resume request.
+ */
+static void Resume(const TimeStamp* now)
+{
+	if (CurrentMode == PAUSED)
 	{
-		g_SevenSeg_time.Hour--;
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			CurrentMode = RESUME;
+			SetValue(&Frozen, now);
+		}
 	}
 }
 
 /**
- * @brief Increments the minute value and wraps to hour if needed.
+ * @brief Starts or stops the stopwatch at a captured photogate edge.
+ *
+ * A paused stopwatch starts at the edge, a running one stops at it, so the
+ * interrupt latency never enters the measurement. Edges within
+ * PHOTOGATE_LOCKOUT_MS of the start are treated as bounce.
+ *
+ * @param stamp Captured edge.
  */
-void IncMin()
+static void GateEdge(const TimeStamp* stamp)
 {
-	if (g_SevenSeg_time.Min == 59)
+	if (CurrentMode == PAUSED)
 	{
-		g_SevenSeg_time.Min = 0;
-		IncHour();
+		Resume(stamp);
+		GateStart = *stamp;
+		GateRunning = TRUE;
 	}
-	else
+	else if (!GateRunning)
+	{
+		Pause(stamp);
+	}
+	else if (stamp->ticks - GateStart.ticks >= PHOTOGATE_LOCKOUT_TICKS)
 	{
-		g_SevenSeg_time.Min++;
+		Pause(stamp);
+		GateCycles = TimeBase_CyclesBetween(&GateStart, stamp);
+		GateRunning = FALSE;
 	}
 }
 
 /**
- * @brief Decrements the minute value and wraps from hour if needed.
+ * @brief Converts a stopwatch value to packed BCD HH:MM:SS.
+ *
+ * @param seconds Whole seconds (0 to STOPWATCH_MAX_SECONDS).
+ * @param time Pointer to the Time struct to fill.
  */
-void DecMin()
+static void SecondsToTime(uint32 seconds, Time* time)
 {
-	if (g_SevenSeg_time.Min == 0)
+	uint8 hours = (uint8)(seconds / 3600);
+	uint16 rest = (uint16)(seconds - (uint32)hours * 3600);
+	uint8 minutes = (uint8)(rest / 60);
+	uint8 secs = (uint8)(rest - (uint16)minutes * 60);
+
+	time->Hour = BIN_TO_BCD(hours);
+	time->Min = BIN_TO_BCD(minutes);
+	time->Sec = BIN_TO_BCD(secs);
+}
+
+/**
+ * @brief Timer0 Compare Match ISR.
+ * Lights the next digit of the time (one BCD nibble per interrupt),
+ * timestamps split presses and samples the buttons every
+ * DEBOUNCE_TICK_DIVIDER interrupts.
+ */
+ISR(TIMER0_COMP_vect)
+{
+	static uint8 digit = 0;
+	static uint8 debounceDivider = 0;
+	static uint8 splitLevel = RELEASED;
+	static uint8 splitLockout = 0;
+
+	// Blank the previous digit before changing the data lines to avoid ghosting
+	CLEAR_REG(SEVEN_SEGMENT_MULT_PORT, SEVEN_SEGMENT_MULT_PIN);
+
+	// Even digits are the tens (high nibble), odd digits the units (low nibble)
+	uint8 field = ((volatile uint8*)&g_SevenSeg_time)[digit >> 1];
+	uint8 data = (digit & 1) ? BCD_UNITS(field) : BCD_TENS(field);
+	WRITE_SEVEN_SEGMENT_FAST(SEVEN_SEGMENT_DATA_PORT, &g_Mult_SevenSegment[digit], data);
+	SET(SEVEN_SEGMENT_MULT_PORT, digit);
+
+	if (++digit == NUM_SEVEN_SEGMENTS)
+	{
+		digit = 0;
+	}
+
+	// Split: the first edge of a level change counts, the bounce after it is ignored
+	if (splitLockout)
 	{
-		g_SevenSeg_time.Min = 59;
-		DecHour();
+		splitLockout--;
 	}
 	else
 	{
-		g_SevenSeg_time.Min--;
+		uint8 split = READ_BUTTON(SPLIT_BB_PORT, SPLIT_BB_PIN, SPLIT_BB_TYPE);
+		if (split != splitLevel)
+		{
+			splitLevel = split;
+			splitLockout = SPLIT_LOCKOUT_DIGITS;
+			if (split == PRESSED)
+			{
+				Lap_Capture();
+			}
+		}
+	}
+
+	// Reset, pause, resume: re-armed once the key has been released for KEY_LOCKOUT_MS
+	if (ResetLockout)
+	{
+		ResetLockout = KeyLockout(ResetLockout, READ_BUTTON(RESET_BB_PORT, RESET_BB_PIN, RESET_BB_TYPE), INT0, INTF0);
+	}
+	if (PauseLockout)
+	{
+		PauseLockout = KeyLockout(PauseLockout, READ_BUTTON(PAUSE_BB_PORT, PAUSE_BB_PIN, PAUSE_BB_TYPE), INT1, INTF1);
+	}
+	if (ResumeLockout)
+	{
+		ResumeLockout = KeyLockout(ResumeLockout, READ_BUTTON(RESUME_BB_PORT, RESUME_BB_PIN, RESUME_BB_TYPE), INT2, INTF2);
+	}
+
+	if (++debounceDivider == DEBOUNCE_TICK_DIVIDER)
+	{
+		debounceDivider = 0;
+
+		uint8 edgePorts = Debounce_Update();
+		if (edgePorts)
+		{
+			EventQueue_Push(EVENT_BUTTON_EDGE, edgePorts);
+		}
 	}
 }
 
 /**
- * @brief Increments the second value and wraps to minute if needed.
+ * @brief Converts a value under an hour to packed BCD MM:SS.hh.
+ *
+ * @param hundredths Hundredths of a second (below DISPLAY_HUNDREDTHS_RANGE).
+ * @param digits Pointer to the Time struct to fill (Hour = MM, Min = SS, Sec = hh).
  */
-void IncSec()
+static void HundredthsToDigits(uint32 hundredths, Time* digits)
+{
+	uint16 seconds = (uint16)(hundredths / 100);
+	uint8 fraction = (uint8)(hundredths - (uint32)seconds * 100);
+	uint8 minutes = (uint8)(seconds / 60);
+	uint8 secs = (uint8)(seconds - (uint16)minutes * 60);
+
+	digits->Hour = BIN_TO_BCD(minutes);
+	digits->Min = BIN_TO_BCD(secs);
+	digits->Sec = BIN_TO_BCD(fraction);
+}
+
+/**
+ * @brief Sets the initial value and renders it.
+ */
+void StopWatch_Init()
+{
+	SetTicks((Ticks)STOPWATCH_INITIAL_SECONDS * TIMEBASE_HZ);
+	RestartLaps((Ticks)STOPWATCH_INITIAL_SECONDS * TIMEBASE_HZ);
+
+	// Matches no value, so the first refresh always renders
+	RenderedHundredths = 0xFFFFFFFF;
+	StopWatch_Refresh();
+}
+
+/**
+ * @brief Copies digits to g_SevenSeg_time.
+ *
+ * @param digits Packed BCD digit pairs to show.
+ */
+static void Show(const Time* digits)
 {
-	if (g_SevenSeg_time.Sec == 59)
+	// The display ISR reads the fields one at a time
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
-		g_SevenSeg_time.Sec = 0;
-		IncMin();
+		g_SevenSeg_time.Hour = digits->Hour;
+		g_SevenSeg_time.Min = digits->Min;
+		g_SevenSeg_time.Sec = digits->Sec;
+	}
+}
+
+/**
+ * @brief Renders a value into g_SevenSeg_time when the shown digits change.
+ *
+ * Below DISPLAY_HUNDREDTHS_RANGE the digits are MM:SS.hh, from there on HH:MM:SS.
+ *
+ * @param hundredths Value in hundredths of a second.
+ */
+static void Render(uint32 hundredths)
+{
+	if (hundredths == RenderedHundredths)
+	{
+		return;
+	}
+	RenderedHundredths = hundredths;
+
+	Time digits;
+	if (hundredths < DISPLAY_HUNDREDTHS_RANGE)
+	{
+		HundredthsToDigits(hundredths, &digits);
 	}
 	else
 	{
-		g_SevenSeg_time.Sec++;
+		SecondsToTime(hundredths / 100, &digits);
 	}
+	Show(&digits);
 }
 
 /**
- * @brief Decrements the second value and wraps from minute if needed.
+ * @brief Shows the next older lap, or the live value after the oldest one.
  */
-void DecSec()
+static void StepRecall()
 {
-	if (g_SevenSeg_time.Sec == 0)
+	Recall = (Recall < Lap_Count()) ? Recall + 1 : 0;
+
+	// Matches no value, so the next refresh always renders
+	RenderedHundredths = 0xFFFFFFFF;
+}
+
+/**
+ * @brief Records a split as a lap, or steps the recall while paused.
+ *
+ * @param split Tick of the split.
+ */
+static void Split(Ticks split)
+{
+	if (CurrentMode == PAUSED)
 	{
-		g_SevenSeg_time.Sec = 59;
-		DecMin();
+		StepRecall();
 	}
 	else
 	{
-		g_SevenSeg_time.Sec--;
+		TimeStamp stamp = { split, 0 };
+		Ticks value = CurrentValue(&stamp);
+		Lap_Record(value);
+		LapLog_Append(value);
+	}
+}
+
+/**
+ * @brief Renders the current value, or the recalled lap.
+ */
+void StopWatch_Refresh()
+{
+	if (ClockShown)
+	{
+		Time digits;
+		Clock_Get(&digits);
+		if (digits.Sec != g_SevenSeg_time.Sec || digits.Min != g_SevenSeg_time.Min || digits.Hour != g_SevenSeg_time.Hour)
+		{
+			Show(&digits);
+		}
+		return;
 	}
+
+	if (Recall)
+	{
+		Render(TimeBase_Hundredths(Lap_Time(Recall - 1)));
+		return;
+	}
+
+	TimeStamp now;
+	TimeStamp value;
+
+	TimeBase_Stamp(&now);
+	ExactValue(&now, &value);
+
+	// Keep the timestamps within 2^31 ticks of now while the value is saturated
+	if (value.counts == 0 && value.ticks == ((g_mode == INCREMENTAL_MODE) ? STOPWATCH_MAX_TICKS : 0))
+	{
+		SetValue(&value, &now);
+	}
+
+	// Whole seconds, then the fraction from the remaining ticks and timer counts
+	uint32 seconds = value.ticks / TIMEBASE_HZ;
+	uint32 counts = (value.ticks - seconds * TIMEBASE_HZ) * TIMEBASE_COUNTS + value.counts;
+	Render(seconds * 100 + (counts * 100) / (TIMEBASE_HZ * TIMEBASE_COUNTS));
+}
+
+/**
+ * @brief Switches the digits between the clock and the stopwatch.
+ */
+void StopWatch_ShowClock(uint8 show)
+{
+	ClockShown = show;
+
+	// Matches no value, so the stopwatch renders again when it comes back
+	RenderedHundredths = 0xFFFFFFFF;
+}
+
+/**
+ * @brief Reports whether a countdown has run out.
+ *
+ * @return uint8 TRUE when counting down and the value is 0, else FALSE.
+ */
+uint8 StopWatch_Expired()
+{
+	TimeStamp now;
+	TimeBase_Stamp(&now);
+
+	return (g_mode == DECREMENTAL_MODE) && (CurrentValue(&now) == 0);
+}
+
+/**
+ * @brief Computes the current time from the timestamps.
+ *
+ * @param time Pointer to the Time struct to fill.
+ */
+void TakeTimeSnapshot(Time* time)
+{
+	TimeStamp now;
+	TimeBase_Stamp(&now);
+
+	SecondsToTime(CurrentValue(&now) / TIMEBASE_HZ, time);
+}
+
+/**
+ * @brief Switches between counting up and counting down, keeping the current value.
+ */
+void StopWatch_ToggleMode()
+{
+	TimeStamp now;
+	TimeStamp value;
+
+	TimeBase_Stamp(&now);
+	ExactValue(&now, &value);
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_mode ^= 1;
+		SetValue(&value, &now);
+	}
+	RestartLaps(value.ticks);
+}
+
+/**
+ * @brief Applies reset, pause, resume, photogate and split events queued by the ISRs.
+ * @param event Pointer to the event taken from the queue.
+ */
+void StopWatch_HandleEvent(const Event* event)
+{
+	TimeStamp now;
+	TimeBase_Stamp(&now);
+
+	switch (event->type)
+	{
+	case EVENT_RESET:
+	{
+		TimeStamp zero = { 0, 0 };
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			g_mode = INCREMENTAL_MODE;
+			SetValue(&zero, &now);
+		}
+		GateRunning = FALSE;
+		RestartLaps(0);
+		break;
+	}
+
+	case EVENT_PAUSE:
+		Pause(&now);
+		GateRunning = FALSE;
+		break;
+
+	case EVENT_RESUME:
+		Resume(&now);
+		EndRecall();
+		break;
+
+	case EVENT_CAPTURE:
+	{
+		TimeStamp stamp;
+		while (TimeBase_PopCapture(&stamp))
+		{
+			GateEdge(&stamp);
+		}
+		break;
+	}
+
+	case EVENT_SPLIT:
+	{
+		// One split per event, so it is handled in order with the events around it
+		Ticks split;
+		if (Lap_PopSplit(&split))
+		{
+			Split(split);
+		}
+		break;
+	}
+
+	case EVENT_TICK:
+	{
+		// Splits whose event found the queue full
+		Ticks split;
+		while (Lap_PopUnsignalled(&split))
+		{
+			Split(split);
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Takes the whole-tick value, the direction and the running flag at the current instant.
+ */
+void StopWatch_GetState(StopWatchState* state)
+{
+	TimeStamp now;
+	TimeBase_Stamp(&now);
+
+	state->value = CurrentValue(&now);
+	state->mode = g_mode;
+	state->running = (CurrentMode != PAUSED);
+}
+
+/**
+ * @brief Sets the direction, pauses and sets the value, then resumes if it was running.
+ */
+void StopWatch_SetState(const StopWatchState* state)
+{
+	Ticks value = (state->value > STOPWATCH_MAX_TICKS) ? STOPWATCH_MAX_TICKS : state->value;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_mode = (state->mode == DECREMENTAL_MODE) ? DECREMENTAL_MODE : INCREMENTAL_MODE;
+		CurrentMode = PAUSED;
+		SetTicks(value);
+	}
+	RestartLaps(value);
+
+	if (state->running)
+	{
+		TimeStamp now;
+		TimeBase_Stamp(&now);
+		Resume(&now);
+	}
+}
+
+/**
+ * @brief Returns the last photogate interval.
+ *
+ * @return uint32 CPU cycles from the start edge to the stop edge, 0 before the first run.
+ */
+uint32 StopWatch_GateCycles()
+{
+	return GateCycles;
+}
+
+/**
+ * @brief Configures the digit select lines and starts the multiplexing timer.
+ */
+void SevenSegmentDisplay_Init()
+{
+	CLEAR_REG(SEVEN_SEGMENT_MULT_PORT, SEVEN_SEGMENT_MULT_PIN);
+	SET_REG(SEVEN_SEGMENT_MULT_DDR, SEVEN_SEGMENT_MULT_PIN);
+
+	Timer0_CTC_Init(DISPLAY_COMPARE_MATCH, DISPLAY_TIMER_PRESCALAR);
+}
+
+/**
+ * @brief Updates the count-up/count-down LEDs based on current stopwatch mode.
+ */
+void UpdateCountLEDs()
+{
+    if (g_mode == INCREMENTAL_MODE)
+    {
+        LED_ON(COUNT_UP_LED_PORT, COUNT_UP_LED_PIN, COUNT_UP_LED_TYPE);
+        LED_OFF(COUNT_DOWN_LED_PORT, COUNT_DOWN_LED_PIN, COUNT_DOWN_LED_TYPE);
+    }
+    else
+    {
+        LED_ON(COUNT_DOWN_LED_PORT, COUNT_DOWN_LED_PIN, COUNT_DOWN_LED_TYPE);
+        LED_OFF(COUNT_UP_LED_PORT, COUNT_UP_LED_PIN, COUNT_UP_LED_TYPE);
+    }
+}
+
+/**
+ * @brief Adds one hour, saturating at 99:59:59.
+ */
+void IncHour()
+{
+	AdjustValue((int32)(3600 * TIMEBASE_HZ));
+}
+
+/**
+ * @brief Subtracts one hour, saturating at 00:00:00.
+ */
+void DecHour()
+{
+	AdjustValue(-(int32)(3600 * TIMEBASE_HZ));
+}
+
+/**
+ * @brief Adds one minute, saturating at 99:59:59.
+ */
+void IncMin()
+{
+	AdjustValue((int32)(60 * TIMEBASE_HZ));
+}
+
+/**
+ * @brief Subtracts one minute, saturating at 00:00:00.
+ */
+void DecMin()
+{
+	AdjustValue(-(int32)(60 * TIMEBASE_HZ));
+}
+
+/**
+ * @brief Adds one second, saturating at 99:59:59.
+ */
+void IncSec()
+{
+	AdjustValue((int32)TIMEBASE_HZ);
+}
+
+/**
+ * @brief Subtracts one second, saturating at 00:00:00.
+ */
+void DecSec()
+{
+	AdjustValue(-(int32)TIMEBASE_HZ);
 }
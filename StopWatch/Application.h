@@ -13,10 +13,15 @@
 
 #include "SevenSegment.h"
 #include "PushButton.h"
-#include "Buzzer.h"
+#include "Tone.h"
 #include "Led.h"
 #include "ExtInterrupts.h"
 #include "Timers.h"
+#include "EventQueue.h"
+#include "TimeBase.h"
+#include "Lap.h"
+#include "LapLog.h"
+#include <util/atomic.h>
 
 /** @name Button Definitions
  *  Macros defining each push button's port, pin, and pull configuration.
@@ -63,6 +68,46 @@
 #define SEC_DEC_BB_TYPE INTERNAL_PULL_UP
 ///@}
 
+/** @name Interrupt Key Lockout
+ *  Reset, pause and resume act on the first edge of their external
+ *  interrupt. The interrupt is then disabled and re-armed by the display
+ *  ISR once the key has read released for KEY_LOCKOUT_MS, so the bounce of
+ *  the press and of the release queues nothing.
+ */
+///@{
+#define KEY_LOCKOUT_MS 20
+#define KEY_LOCKOUT_DIGITS ((uint8)((KEY_LOCKOUT_MS * DISPLAY_DIGIT_RATE + 999) / 1000))
+///@}
+
+/** @name Photogate Definitions
+ *  Start/stop input on ICP1. Its edges are timestamped by Timer1 in hardware;
+ *  a second edge within PHOTOGATE_LOCKOUT_MS of the start is ignored.
+ *  Only available with the Timer1 timebase (TIMEBASE_HAS_CAPTURE).
+ */
+///@{
+#define PHOTOGATE_PIN PD6
+#define PHOTOGATE_PORT 'D'
+#define PHOTOGATE_TYPE INTERNAL_PULL_UP
+#define PHOTOGATE_EDGE CAPTURE_FALLING_EDGE
+#define PHOTOGATE_LOCKOUT_MS 50
+#define PHOTOGATE_LOCKOUT_TICKS ((Ticks)PHOTOGATE_LOCKOUT_MS * TIMEBASE_HZ / 1000)
+///@}
+
+/** @name Split Definitions
+ *  Split (lap) input, sampled by the display ISR at DISPLAY_DIGIT_RATE.
+ *  The first edge of a press is timestamped; the input is then ignored for
+ *  SPLIT_LOCKOUT_MS to ride out contact bounce, so up to
+ *  1000 / (2 * SPLIT_LOCKOUT_MS) splits a second are taken.
+ *  While paused, a press steps through the lap memory instead.
+ */
+///@{
+#define SPLIT_BB_PIN PD0
+#define SPLIT_BB_PORT 'D'
+#define SPLIT_BB_TYPE INTERNAL_PULL_UP
+#define SPLIT_LOCKOUT_MS 10
+#define SPLIT_LOCKOUT_DIGITS ((uint8)((SPLIT_LOCKOUT_MS * DISPLAY_DIGIT_RATE + 999) / 1000))
+///@}
+
 /** @name LED and Buzzer Definitions */
 ///@{
 #define COUNT_UP_LED_PORT 'D'
@@ -73,8 +118,13 @@
 #define COUNT_DOWN_LED_PIN PD5
 #define COUNT_DOWN_LED_TYPE NEGATIVE_LOGIC
 
-#define BUZZER_PIN PD0
+#define BUZZER_PIN PD7          /**< OC2, the Timer2 tone output */
 #define BUZZER_PORT 'D'
+#define ALARM_TIMEOUT_MS 60000U /**< The countdown alarm stops by itself after a minute */
+
+#if TONE_HARDWARE && (BUZZER_PIN != PD7 || BUZZER_PORT != 'D')
+#error "The Timer2 tone output is fixed to OC2 (PD7)"
+#endif
 ///@}
 
 /** @name Seven Segment Configuration */
@@ -83,29 +133,111 @@
 #define SEVEN_SEGMENT_DATA_PORT 'C'
 #define SEVEN_SEGMENT_DATA_PINS 0x0F
 #define SEVEN_SEGMENT_MULT_PORT PORTA
+#define SEVEN_SEGMENT_MULT_DDR DDRA
 #define SEVEN_SEGMENT_MULT_PIN 0x3F
 ///@}
 
+/** @name Display Refresh Configuration
+ *  Timer0 runs in CTC mode and lights one digit per compare match interrupt,
+ *  so the interrupt rate is DISPLAY_REFRESH_RATE * NUM_SEVEN_SEGMENTS.
+ */
+///@{
+#define DISPLAY_REFRESH_RATE 100                /**< Full display frames per second */
+#define DISPLAY_TIMER_PRESCALAR PRESCALAR_256   /**< Timer0 clock source */
+#define DISPLAY_TIMER_DIVISION 256UL            /**< Division factor matching DISPLAY_TIMER_PRESCALAR */
+#define DISPLAY_TIMER_COUNTS ((F_CPU / DISPLAY_TIMER_DIVISION) / (DISPLAY_REFRESH_RATE * NUM_SEVEN_SEGMENTS))
+#define DISPLAY_COMPARE_MATCH ((uint8)(DISPLAY_TIMER_COUNTS - 1))
+
+#if (DISPLAY_TIMER_COUNTS < 2) || (DISPLAY_TIMER_COUNTS > 256)
+#error "DISPLAY_REFRESH_RATE cannot be reached with DISPLAY_TIMER_PRESCALAR on Timer0"
+#endif
+///@}
+
+/** @name Debounce Configuration
+ *  The debouncer runs from the display ISR, every DEBOUNCE_TICK_DIVIDER
+ *  digit interrupts, which keeps its sample period between 1 and 2 ms.
+ *  A level is accepted after 4 equal samples.
+ */
+///@{
+#define DISPLAY_DIGIT_RATE (DISPLAY_REFRESH_RATE * NUM_SEVEN_SEGMENTS)
+#define DEBOUNCE_TICK_DIVIDER ((DISPLAY_DIGIT_RATE + 999) / 1000)
+
+#define DEBOUNCE_PERIOD_US ((1000000UL * DEBOUNCE_TICK_DIVIDER) / DISPLAY_DIGIT_RATE)
+#define MS_TO_DEBOUNCE_TICKS(ms) ((uint16)(((ms) * 1000UL) / DEBOUNCE_PERIOD_US))
+
+#if DISPLAY_DIGIT_RATE < 500
+#error "Display interrupt is too slow to sample the buttons every 2 ms"
+#endif
+
+/// Bit of a button pin in the mask of port @p index, 0 if it is on another port
+#define DEBOUNCE_BIT(port, pin, index) (((port) - 'A' == (index)) ? (1 << (pin)) : 0)
+
+/// Debounced pins of port @p index: the buttons the main loop samples. Outputs,
+/// the open PA6 and the keys handled by their own ISR code never queue EVENT_BUTTON_EDGE.
+#define DEBOUNCE_PINS(index) \
+	(DEBOUNCE_BIT(MODE_BB_PORT, MODE_BB_PIN, index) | \
+	 DEBOUNCE_BIT(HR_INC_BB_PORT, HR_INC_BB_PIN, index) | \
+	 DEBOUNCE_BIT(HR_DEC_BB_PORT, HR_DEC_BB_PIN, index) | \
+	 DEBOUNCE_BIT(MIN_INC_BB_PORT, MIN_INC_BB_PIN, index) | \
+	 DEBOUNCE_BIT(MIN_DEC_BB_PORT, MIN_DEC_BB_PIN, index) | \
+	 DEBOUNCE_BIT(SEC_INC_BB_PORT, SEC_INC_BB_PIN, index) | \
+	 DEBOUNCE_BIT(SEC_DEC_BB_PORT, SEC_DEC_BB_PIN, index))
+///@}
+
+/** @name Time Adjustment Auto-repeat
+ *  Holding an adjust button steps once, waits AUTOREPEAT_DELAY_MS, then repeats
+ *  every AUTOREPEAT_PERIOD_MS, halving the period after every
+ *  AUTOREPEAT_ACCEL_STEPS repeats down to AUTOREPEAT_MIN_PERIOD_MS.
+ */
+///@{
+#define AUTOREPEAT_DELAY_MS      500
+#define AUTOREPEAT_PERIOD_MS     200
+#define AUTOREPEAT_MIN_PERIOD_MS 25
+#define AUTOREPEAT_ACCEL_STEPS   5
+///@}
+
+/** @name Clock View
+ *  Holding the mode button for CLOCK_VIEW_HOLD_MS switches the digits
+ *  between the stopwatch and the time of day (see Clock.h); a shorter press
+ *  toggles the count direction. While the clock is shown, the adjustment
+ *  buttons set the clock and the stopwatch keeps counting unseen.
+ */
+///@{
+#define CLOCK_VIEW_HOLD_MS 1000
+///@}
+
 /** @name Stopwatch Mode Constants */
 ///@{
 #define DECREMENTAL_MODE 0
 #define INCREMENTAL_MODE 1
-#define ToggleStopWatchMode ( g_mode ^= (1) )
 ///@}
 
-/**
- * @brief Compare match value for 1-second tick at 1 MHz CPU frequency and prescaler of 64.
+/** @name Stopwatch Range */
+///@{
+#define STOPWATCH_MAX_SECONDS 359999UL                                   /**< 99:59:59 */
+#define STOPWATCH_MAX_TICKS ((Ticks)STOPWATCH_MAX_SECONDS * TIMEBASE_HZ)
+#define STOPWATCH_INITIAL_SECONDS (3 * 3600UL + 59 * 60 + 46)            /**< 03:59:46 at power-up */
+///@}
+
+/** @name Display Range
+ *  Values below an hour are shown as MM:SS.hh, longer ones as HH:MM:SS.
  */
-#define COMPARE_MATCH_FOR_1SEC ((uint16)15625)
+///@{
+#define DISPLAY_HUNDREDTHS_RANGE (3600UL * 100)
+///@}
 
 /**
  * @brief Struct representing a time format (hours, minutes, seconds).
+ *
+ * Every field is packed BCD, so each nibble is one display digit.
+ * In g_SevenSeg_time the fields are the three digit pairs on the display,
+ * which hold MM, SS and hundredths while the value is under an hour.
  */
 typedef struct
 {
-	uint8 Hour; /**< Hours (0–23) */
-	uint8 Min;  /**< Minutes (0–59) */
-	uint8 Sec;  /**< Seconds (0–59) */
+	uint8 Hour; /**< Hours, packed BCD (0x00–0x99) */
+	uint8 Min;  /**< Minutes, packed BCD (0x00–0x59) */
+	uint8 Sec;  /**< Seconds, packed BCD (0x00–0x59) */
 } Time;
 
 typedef enum
@@ -114,30 +246,143 @@ typedef enum
 	RESUME
 }StopWatchMode;
 
-extern StopWatchMode CurrentMode;
+/**
+ * @brief Stopwatch state that survives a power cycle (see Persist.h).
+ */
+typedef struct
+{
+	Ticks value;   /**< Stopwatch value in ticks */
+	uint8 mode;    /**< INCREMENTAL_MODE or DECREMENTAL_MODE */
+	uint8 running; /**< TRUE if not paused */
+} StopWatchState;
+
+/// Running state, changed only by StopWatch_HandleEvent() in the main loop.
+extern volatile StopWatchMode CurrentMode;
 
-/// Global stopwatch time.
-extern Time g_SevenSeg_time;
+/// Displayed time, written only by StopWatch_Refresh() and read by the display ISR.
+extern volatile Time g_SevenSeg_time;
 
-/// Current stopwatch mode (incremental or decremental).
+/// Current stopwatch mode (incremental or decremental). Change it with StopWatch_ToggleMode().
 extern volatile uint8 g_mode;
 
 /// Array holding seven segment display structures.
 extern SevenSegment g_Mult_SevenSegment[NUM_SEVEN_SEGMENTS];
 
 /**
- * @brief Updates the state of count-up and count-down LEDs based on the stopwatch mode.
- * @param countUp Pointer to the count-up LED object.
- * @param countDown Pointer to the count-down LED object.
+ * @brief Updates the state of the count-up and count-down LEDs based on the stopwatch mode.
+ *
+ * The LEDs must have been initialized with Led_Init() on the COUNT_*_LED pins.
+ */
+extern void UpdateCountLEDs();
+
+/**
+ * @brief Starts the interrupt-driven display multiplexing on Timer0.
+ *
+ * The display ISR shows the BCD nibbles of g_SevenSeg_time directly.
+ * The seven segment structures in g_Mult_SevenSegment must be initialized first.
+ */
+void SevenSegmentDisplay_Init();
+
+/**
+ * @brief Sets the power-up value (STOPWATCH_INITIAL_SECONDS) and renders it.
+ *
+ * The stopwatch keeps no running count: its value is derived from timestamps
+ * of the TimeBase, so TimeBase_Init() must be called first. Lap_Init() and
+ * LapLog_Init() must have been called too.
+ */
+void StopWatch_Init();
+
+/**
+ * @brief Updates g_SevenSeg_time from the current value, or from the clock.
+ *
+ * Call it from the main loop; the BCD conversion only runs when the shown
+ * digits change (at most 100 times a second).
+ */
+void StopWatch_Refresh();
+
+/**
+ * @brief Shows the time of day instead of the stopwatch, or goes back to it.
+ *
+ * Takes effect at the next StopWatch_Refresh(). Requires Clock_Init().
+ *
+ * @param show TRUE for the time of day, FALSE for the stopwatch.
+ */
+void StopWatch_ShowClock(uint8 show);
+
+/**
+ * @brief Computes the current time as packed BCD HH:MM:SS.
+ *
+ * @param time Pointer to the Time struct to fill.
+ */
+void TakeTimeSnapshot(Time* time);
+
+/**
+ * @brief Switches between counting up and counting down without changing the value.
+ *
+ * The laps restart from the current value.
+ */
+void StopWatch_ToggleMode();
+
+/**
+ * @brief Reports whether a countdown has run out.
+ *
+ * @return uint8 TRUE when counting down and the value has reached 00:00:00.00.
+ */
+uint8 StopWatch_Expired();
+
+/**
+ * @brief Applies a reset, pause, resume, photogate capture or split event in main-loop context.
+ *
+ * A split while running records a lap; while paused it shows the next
+ * older lap time (newest first), and after the oldest one the live value
+ * again. Recorded laps are also appended to the EEPROM lap log. Reset
+ * clears the laps and starts a new log session; resume and reset end the
+ * recall.
+ *
+ * Each split event takes one buffered split, so splits and the pause or
+ * reset events around them are handled in the order they happened. A
+ * tick event takes the splits whose event was lost to a full queue.
+ *
+ * Other event types are ignored.
+ *
+ * @param event Pointer to an event taken from the event queue.
+ */
+void StopWatch_HandleEvent(const Event* event);
+
+/**
+ * @brief Reads the current state.
+ *
+ * Safe from an interrupt (the power-fail save): the main loop changes the
+ * timestamps, the direction and the running flag only with interrupts off.
+ *
+ * @param state Pointer to the state to fill.
+ */
+void StopWatch_GetState(StopWatchState* state);
+
+/**
+ * @brief Restores a saved state.
+ *
+ * The value is clamped to STOPWATCH_MAX_TICKS; the laps restart from it.
+ *
+ * @param state State to restore; counting resumes from the value if state->running is TRUE.
  */
-extern void UpdateCountLEDs(Led* countUp, Led* countDown);
+void StopWatch_SetState(const StopWatchState* state);
 
 /**
- * @brief Refreshes the seven segment display with current time.
+ * @brief Returns the last interval measured by the photogate.
+ *
+ * The interval runs from the start edge to the stop edge at CPU clock
+ * resolution (1/16 us), up to about 268 s.
+ *
+ * @return uint32 Interval in CPU cycles, 0 before the first complete run.
  */
-void SevenSegmentUpdate();
+uint32 StopWatch_GateCycles();
 
-/** @name Stopwatch Control Functions */
+/** @name Stopwatch Control Functions
+ *  Adjust the value by one hour, minute or second, saturating at 00:00:00
+ *  and 99:59:59, without touching the fraction of a second. They work
+ *  while running and while paused; the laps restart from the new value.
+ */
 ///@{
 void IncHour();
 void DecHour();
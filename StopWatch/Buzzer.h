@@ -22,6 +22,14 @@ typedef struct
 	uint8 pin;  /**< Pin number (0 to 7) */
 } Buzzer;
 
+/** @name Compile-time Buzzer Access
+ *  For a buzzer whose port and pin are compile-time constants.
+ *  @{
+ */
+#define BUZZER_ON(port, pin)   FAST_WRITE_PIN(port, pin, HIGH)
+#define BUZZER_OFF(port, pin)  FAST_WRITE_PIN(port, pin, LOW)
+/** @} */
+
 /**
  * @brief Initialize the buzzer by setting the corresponding pin as output.
  *
@@ -0,0 +1,121 @@
+/**
+ * @file Calibration.c
+ * @brief Measures, applies and stores the crystal trim.
+ */
+
+#include "Calibration.h"
+#include "Eeprom.h"
+#include <avr/eeprom.h>
+
+/// Mixed into the check: 0 for Timer1 (the CPU crystal), so its records stay valid
+#define CALIBRATION_SOURCE_TAG ((uint16)((TIMEBASE_SOURCE - TIMEBASE_TIMER1) * 0x5A5AU))
+
+/// Largest cycle count error of a measurement, TIMEBASE_TRIM_LIMIT in cycles
+#define CALIBRATION_ERROR_LIMIT ((uint32)TIMEBASE_TRIM_LIMIT * CALIBRATION_PULSES * (F_CPU / 1000000UL) / 100)
+
+/**
+ * @brief EEPROM record of the trim; check is the complement of the value, tagged with the source.
+ */
+typedef struct
+{
+	int16 centiPpm; /**< Crystal error in 0.01 ppm */
+	uint16 check;   /**< ~centiPpm ^ CALIBRATION_SOURCE_TAG, so erased (0xFF) cells do not pass */
+} CalibrationRecord;
+
+/// Stored trim
+static EEMEM CalibrationRecord StoredCalibration;
+
+/**
+ * @brief Reads the stored trim and applies it when the record is valid.
+ */
+void Calibration_Load()
+{
+	CalibrationRecord record;
+	Eeprom_ReadBlock(&record, &StoredCalibration, sizeof(record));
+
+	if ((uint16)(record.check ^ (uint16)record.centiPpm ^ CALIBRATION_SOURCE_TAG) == 0xFFFF)
+	{
+		TimeBase_SetTrim(record.centiPpm);
+	}
+}
+
+#if TIMEBASE_HAS_CAPTURE
+
+/**
+ * @brief Shows the number of received pulses on the seconds digits.
+ *
+ * @param pulses Pulses received so far.
+ */
+static void ShowProgress(uint8 pulses)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		g_SevenSeg_time.Hour = 0;
+		g_SevenSeg_time.Min = BIN_TO_BCD(pulses / 100);
+		g_SevenSeg_time.Sec = BIN_TO_BCD(pulses % 100);
+	}
+}
+
+/**
+ * @brief Timestamps CALIBRATION_PULSES reference periods and derives the trim.
+ *
+ * The measurement runs untrimmed, so the captured cycle count is the real
+ * crystal frequency: error = (cycles - N * F_CPU) / (N * F_CPU).
+ *
+ * @return uint8 TRUE if a new trim was stored.
+ */
+uint8 Calibration_Run()
+{
+	TimeStamp first;
+	TimeStamp stamp;
+	uint8 pulses = 0;
+	int16 previous = TimeBase_Trim();
+
+	TimeBase_SetTrim(0);
+	ShowProgress(0);
+
+	while (pulses <= CALIBRATION_PULSES)
+	{
+		Event event;
+		if (!EventQueue_Pop(&event))
+		{
+			continue;
+		}
+
+		if (event.type == EVENT_RESET)
+		{
+			TimeBase_SetTrim(previous);
+			return FALSE;
+		}
+
+		while (event.type == EVENT_CAPTURE && pulses <= CALIBRATION_PULSES && TimeBase_PopCapture(&stamp))
+		{
+			if (pulses == 0)
+			{
+				first = stamp;
+			}
+			ShowProgress(pulses++);
+		}
+	}
+
+	// Range check on the raw cycle count: missed pulses or a saturated count
+	// would overflow the scaling below
+	uint32 cycles = TimeBase_CyclesBetween(&first, &stamp);
+	if (cycles > CALIBRATION_PULSES * F_CPU + CALIBRATION_ERROR_LIMIT ||
+	    cycles < CALIBRATION_PULSES * F_CPU - CALIBRATION_ERROR_LIMIT)
+	{
+		TimeBase_SetTrim(previous);
+		return FALSE;
+	}
+
+	int32 error = (int32)(cycles - CALIBRATION_PULSES * F_CPU);
+	int32 centiPpm = (error * 100) / (CALIBRATION_PULSES * (int32)(F_CPU / 1000000UL));
+
+	CalibrationRecord record = { (int16)centiPpm, (uint16)~centiPpm ^ CALIBRATION_SOURCE_TAG };
+	Eeprom_WriteBlock(&record, &StoredCalibration, sizeof(record));
+	TimeBase_SetTrim(record.centiPpm);
+
+	return TRUE;
+}
+
+#endif // TIMEBASE_HAS_CAPTURE
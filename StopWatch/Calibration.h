@@ -0,0 +1,57 @@
+/**
+ * @file Calibration.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Crystal drift calibration against a 1 PPS reference.
+ *
+ * The crystal error is measured by timestamping the edges of a one pulse per
+ * second reference (GPS receiver, frequency standard) on the photogate input,
+ * applied with TimeBase_SetTrim() and kept in EEPROM.
+ *
+ * Procedure: connect the reference to the photogate input, hold the mode
+ * button while powering up, and wait CALIBRATION_PULSES seconds. The digits
+ * count the received pulses; the stopwatch starts normally once the trim
+ * is stored. The reset button aborts and keeps the previous trim.
+ *
+ * The measurement needs input capture, so Calibration_Run() is only built
+ * with the Timer1 timebase (TIMEBASE_HAS_CAPTURE). Calibration_Load() is
+ * built with both: the record is tagged with the timebase source, so a
+ * trim measured on the CPU crystal is never applied to the watch crystal.
+ * A watch crystal trim is stored by writing the record into the EEPROM
+ * image (for example from a frequency counter reading).
+ */
+
+#include "Application.h"
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+/** @name Calibration Configuration */
+///@{
+#define CALIBRATION_PULSES 60   /**< Reference periods measured (at most 268 s of cycles) */
+///@}
+
+/**
+ * @brief Apply the trim stored in EEPROM.
+ *
+ * An erased or corrupted record, or one stored for the other timebase
+ * source, leaves the timebase untrimmed.
+ * Requires TimeBase_Init().
+ */
+void Calibration_Load();
+
+#if TIMEBASE_HAS_CAPTURE
+/**
+ * @brief Measure the crystal error against the reference and store it.
+ *
+ * Blocks until CALIBRATION_PULSES periods were measured or the reset button
+ * was pressed. Requires TimeBase_Init(), TimeBase_Capture_Init() and the
+ * display to be running. A result beyond TIMEBASE_TRIM_LIMIT is taken as a
+ * bad reference and discarded.
+ *
+ * @return uint8 TRUE if a new trim was stored, FALSE if aborted or discarded.
+ */
+uint8 Calibration_Run();
+#endif
+
+#endif // CALIBRATION_H
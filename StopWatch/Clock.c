@@ -0,0 +1,78 @@
+/**
+ * @file Clock.c
+ * @brief Time of day as an offset from a midnight timestamp.
+ */
+
+#include "Clock.h"
+
+/// Timebase tick at the last midnight
+static Ticks DayStart;
+
+/// Hourly rollover check
+static SoftTimer UpdateTimer;
+
+/**
+ * @brief Advances the midnight timestamp once a day has passed.
+ */
+static void Clock_Update(void* context)
+{
+	if (TimeBase_Now() - DayStart >= CLOCK_DAY_TICKS)
+	{
+		DayStart += CLOCK_DAY_TICKS;
+	}
+}
+
+/**
+ * @brief Starts the clock at midnight and the hourly rollover timer.
+ */
+void Clock_Init()
+{
+	DayStart = TimeBase_Now();
+
+	SoftTimer_Init(&UpdateTimer, Clock_Update, NULL);
+	SoftTimer_Start(&UpdateTimer, CLOCK_UPDATE_TICKS, CLOCK_UPDATE_TICKS);
+}
+
+/**
+ * @brief Moves the midnight timestamp, keeping it within the last day.
+ */
+void Clock_Adjust(int32 seconds)
+{
+	DayStart -= (Ticks)(seconds * (int32)TIMEBASE_HZ);
+
+	Ticks now = TimeBase_Now();
+	while ((int32)(now - DayStart) < 0)
+	{
+		DayStart -= CLOCK_DAY_TICKS;
+	}
+	while (now - DayStart >= CLOCK_DAY_TICKS)
+	{
+		DayStart += CLOCK_DAY_TICKS;
+	}
+}
+
+/**
+ * @brief Computes the time of day from the midnight timestamp.
+ *
+ * @param time Pointer to the Time struct to fill.
+ */
+void Clock_Get(Time* time)
+{
+	Ticks sinceMidnight = TimeBase_Now() - DayStart;
+
+	// The hourly rollover may not have run since midnight
+	if (sinceMidnight >= CLOCK_DAY_TICKS)
+	{
+		sinceMidnight -= CLOCK_DAY_TICKS;
+	}
+
+	uint32 seconds = sinceMidnight / TIMEBASE_HZ;
+	uint8 hours = (uint8)(seconds / 3600);
+	uint16 rest = (uint16)(seconds - (uint32)hours * 3600);
+	uint8 minutes = (uint8)(rest / 60);
+
+	time->Hour = BIN_TO_BCD(hours);
+	time->Min = BIN_TO_BCD(minutes);
+	time->Sec = BIN_TO_BCD(rest - (uint16)minutes * 60);
+}
+
@@ -0,0 +1,50 @@
+/**
+ * @file Clock.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Time-of-day clock running alongside the stopwatch.
+ *
+ * Like the stopwatch, the clock is a timestamp on the shared timebase, so it
+ * costs no ISR work. With the Timer2 watch crystal timebase it keeps time
+ * through power-save sleep.
+ *
+ * It is shown on the digits with StopWatch_ShowClock() (a long press of the
+ * mode button) and set with the time adjustment buttons while shown.
+ */
+
+#include "Application.h"
+#include "Scheduler.h"
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+/** @brief Timebase ticks in a day. */
+#define CLOCK_DAY_TICKS ((Ticks)86400UL * TIMEBASE_HZ)
+
+/** @brief Period of the midnight rollover check. */
+#define CLOCK_UPDATE_TICKS ((Ticks)3600UL * TIMEBASE_HZ)
+
+/**
+ * @brief Start the clock at 00:00:00.
+ *
+ * Registers an hourly scheduler timer that rolls the clock over at
+ * midnight, so timestamp differences never reach the 2^31 tick limit.
+ * Requires Scheduler_Init().
+ */
+void Clock_Init();
+
+/**
+ * @brief Move the time of day forward or back, wrapping at midnight.
+ *
+ * @param seconds Signed amount, at most a day either way.
+ */
+void Clock_Adjust(int32 seconds);
+
+/**
+ * @brief Read the time of day as packed BCD HH:MM:SS.
+ *
+ * @param time Pointer to the Time struct to fill.
+ */
+void Clock_Get(Time* time);
+
+#endif // CLOCK_H
@@ -53,6 +53,14 @@ typedef long double float128;  /**< Extended precision floating-point number */
 /** @brief Logical LOW (typically 0 for digital pins). */
 #define LOW 0
 
+/**
+ * @brief Force a static function to be inlined, even when optimizing for size.
+ *
+ * Used on interrupt paths where a call would make avr-gcc save every
+ * call-clobbered register in the ISR prologue.
+ */
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
 /** @brief Number of bits in a register (8-bit AVR). */
 #define REGISTER_SIZE 8
 
@@ -99,12 +107,12 @@ typedef long double float128;  /**< Extended precision floating-point number */
 #define IS_CLEAR(REG, BIT)         (~( REG & (1 << BIT) ))
 
 /**
- * @brief Apply a bitmask to a register with new data.
+ * @brief Replace the masked bits of a register with new data in a single store.
  * @param REG The register to modify.
- * @param MUSK The bitmask to preserve bits.
- * @param DATA The new data to apply to bits not masked.
+ * @param MUSK The bitmask selecting the bits to replace.
+ * @param DATA The new data for the masked bits (bits outside MUSK are ignored).
  */
-#define MUSK_REG(REG, MUSK, DATA)  ( REG |= ( REG & MUSK ) | ( DATA & ~(MUSK)) )
+#define MUSK_REG(REG, MUSK, DATA)  ( REG = ( REG & ~(MUSK) ) | ( (DATA) & (MUSK) ) )
 
 /**
  * @brief Set specific bits in a register.
@@ -123,4 +131,23 @@ typedef long double float128;  /**< Extended precision floating-point number */
 
 /** @} */ // end of Bit Manipulation Macros
 
+/** @name Packed BCD Macros
+ *  Two decimal digits per byte: tens in the high nibble, units in the low nibble.
+ *  @{
+ */
+
+/** @brief Convert packed BCD (0x00–0x99) to binary (0–99). */
+#define BCD_TO_BIN(X)  ( ((X) >> 4) * 10 + ((X) & 0x0F) )
+
+/** @brief Convert binary (0–99) to packed BCD (0x00–0x99). */
+#define BIN_TO_BCD(X)  ( (((X) / 10) << 4) | ((X) % 10) )
+
+/** @brief Tens digit of a packed BCD value. */
+#define BCD_TENS(X)    ( (X) >> 4 )
+
+/** @brief Units digit of a packed BCD value. */
+#define BCD_UNITS(X)   ( (X) & 0x0F )
+
+/** @} */ // end of Packed BCD Macros
+
 #endif // DEFS_H
@@ -6,34 +6,67 @@
 C_SRCS += \
 ../Application.c \
 ../Buzzer.c \
+../Calibration.c \
+../Clock.c \
+../Eeprom.c \
+../EventQueue.c \
 ../ExtInterrupts.c \
 ../GPIO.c \
+../Lap.c \
+../LapLog.c \
 ../Led.c \
+../Persist.c \
+../Power.c \
 ../PushButton.c \
+../Scheduler.c \
 ../SevenSegment.c \
+../TimeBase.c \
 ../Timers.c \
+../Tone.c \
 ../main.c 
 
 OBJS += \
 ./Application.o \
 ./Buzzer.o \
+./Calibration.o \
+./Clock.o \
+./Eeprom.o \
+./EventQueue.o \
 ./ExtInterrupts.o \
 ./GPIO.o \
+./Lap.o \
+./LapLog.o \
 ./Led.o \
+./Persist.o \
+./Power.o \
 ./PushButton.o \
+./Scheduler.o \
 ./SevenSegment.o \
+./TimeBase.o \
 ./Timers.o \
+./Tone.o \
 ./main.o 
 
 C_DEPS += \
 ./Application.d \
 ./Buzzer.d \
+./Calibration.d \
+./Clock.d \
+./Eeprom.d \
+./EventQueue.d \
 ./ExtInterrupts.d \
 ./GPIO.d \
+./Lap.d \
+./LapLog.d \
 ./Led.d \
+./Persist.d \
+./Power.d \
 ./PushButton.d \
+./Scheduler.d \
 ./SevenSegment.d \
+./TimeBase.d \
 ./Timers.d \
+./Tone.d \
 ./main.d 
 
 
@@ -41,7 +74,7 @@ C_DEPS += \
 %.o: ../%.c subdir.mk
 	@echo 'Building file: $<'
 	@echo 'Invoking: AVR Compiler'
-	avr-gcc -Wall -g2 -gstabs -O0 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=16000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
+	avr-gcc -Wall -g2 -gstabs -Os -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=16000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
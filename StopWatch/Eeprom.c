@@ -0,0 +1,243 @@
+/**
+ * @file Eeprom.c
+ * @brief EEPROM write queue drained by the EE_RDY interrupt.
+ */
+
+#include "Eeprom.h"
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+
+#define EEPROM_QUEUE_MASK (EEPROM_QUEUE_SIZE - 1)
+
+/**
+ * @brief A queued byte write.
+ */
+typedef struct
+{
+	uint8* address;
+	uint8 value;
+} EepromWrite;
+
+/// Pending writes, produced by the main loop and consumed by the EE_RDY ISR
+static volatile EepromWrite Queue[EEPROM_QUEUE_SIZE];
+static volatile uint8 Head;
+static volatile uint8 Tail;
+
+/// TRUE while the byte taken last is being written
+static volatile uint8 Writing;
+
+/// Writes queued and writes finished (written or skipped), for the fences
+static uint16 Queued;
+static volatile uint16 Retired;
+
+/// Statistics
+static uint8 MaxDepth;
+static volatile uint16 Written;
+static volatile uint16 Skipped;
+static uint16 Rejected;
+
+/**
+ * @brief EEPROM Ready ISR.
+ * Retires the finished write and starts the next queued byte that differs
+ * from the EEPROM contents; disables itself when the queue is empty.
+ */
+ISR(EE_RDY_vect)
+{
+	if (Writing)
+	{
+		Writing = FALSE;
+		Retired++;
+	}
+
+	uint8 tail = Tail;
+	while (tail != Head)
+	{
+		uint8* address = Queue[tail & EEPROM_QUEUE_MASK].address;
+		uint8 value = Queue[tail & EEPROM_QUEUE_MASK].value;
+		Tail = ++tail;
+
+		// No write in progress here, so the read does not wait
+		if (eeprom_read_byte(address) == value)
+		{
+			Skipped++;
+			Retired++;
+			continue;
+		}
+
+		EEAR = (uint16)address;
+		EEDR = value;
+		SET(EECR, EEMWE);   // EEWE must follow within 4 cycles; interrupts are off in the ISR
+		SET(EECR, EEWE);
+
+		Writing = TRUE;
+		Written++;
+		return;
+	}
+
+	CLEAR(EECR, EERIE);
+}
+
+/**
+ * @brief Stops the interrupt and empties the queue.
+ */
+void Eeprom_Init()
+{
+	CLEAR(EECR, EERIE);
+
+	Head = 0;
+	Tail = 0;
+	Writing = FALSE;
+	Queued = 0;
+	Retired = 0;
+	MaxDepth = 0;
+	Written = 0;
+	Skipped = 0;
+	Rejected = 0;
+}
+
+/**
+ * @brief Appends one entry; the caller has checked for room.
+ */
+static void Push(uint8* address, uint8 value)
+{
+	uint8 head = Head;
+
+	Queue[head & EEPROM_QUEUE_MASK].address = address;
+	Queue[head & EEPROM_QUEUE_MASK].value = value;
+	Head = head + 1; // publish only after the entry is complete
+	Queued++;
+
+	uint8 depth = (uint8)(Head - Tail);
+	if (depth > MaxDepth)
+	{
+		MaxDepth = depth;
+	}
+}
+
+/**
+ * @brief Queues a byte and makes sure the drain interrupt is on.
+ */
+uint8 Eeprom_Write(uint8* address, uint8 value)
+{
+	return Eeprom_WriteBlock(&value, address, 1);
+}
+
+/**
+ * @brief Queues a block if all of it fits.
+ */
+uint8 Eeprom_WriteBlock(const void* source, void* address, uint8 length)
+{
+	if (length > Eeprom_Free())
+	{
+		Rejected++;
+		return FALSE;
+	}
+
+	for (uint8 i = 0; i < length; i++)
+	{
+		Push((uint8*)address + i, ((const uint8*)source)[i]);
+	}
+
+	// Single sbi, so it cannot undo the ISR clearing EERIE on an empty queue
+	SET(EECR, EERIE);
+	return TRUE;
+}
+
+/**
+ * @brief Reads one byte.
+ */
+uint8 Eeprom_Read(const uint8* address)
+{
+	uint8 value;
+	Eeprom_ReadBlock(&value, address, 1);
+	return value;
+}
+
+/**
+ * @brief Masks EERIE around the avr-libc read so the ISR cannot move EEAR under it.
+ */
+void Eeprom_ReadBlock(void* destination, const void* address, uint8 length)
+{
+	CLEAR(EECR, EERIE);
+
+	eeprom_read_block(destination, address, length);
+
+	// The ISR retires a write it started and drains what is left
+	if (Writing || Tail != Head)
+	{
+		SET(EECR, EERIE);
+	}
+}
+
+/**
+ * @brief Returns the number of free entries.
+ */
+uint8 Eeprom_Free()
+{
+	return EEPROM_QUEUE_SIZE - (uint8)(Head - Tail);
+}
+
+/**
+ * @brief Returns the number of writes queued so far.
+ */
+uint16 Eeprom_Fence()
+{
+	return Queued;
+}
+
+/**
+ * @brief Compares the retired count with the ticket, across wrap-around.
+ */
+uint8 Eeprom_Done(uint16 ticket)
+{
+	uint16 retired;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		retired = Retired;
+	}
+	return (int16)(retired - ticket) >= 0;
+}
+
+/**
+ * @brief Spins until every queued byte is written.
+ */
+void Eeprom_Flush()
+{
+	uint16 ticket = Eeprom_Fence();
+	while (!Eeprom_Done(ticket))
+	{
+	}
+}
+
+/**
+ * @brief Stops the drain interrupt, lets the write in progress finish and empties the queue.
+ */
+void Eeprom_Abort()
+{
+	CLEAR(EECR, EERIE);
+	while (IS_SET(EECR, EEWE))
+	{
+	}
+
+	if (Writing)
+	{
+		Writing = FALSE;
+		Retired++;
+	}
+	Tail = Head;
+}
+
+/**
+ * @brief Copies the counters.
+ */
+void Eeprom_GetStats(EepromStats* stats)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		stats->depth = (uint8)(Head - Tail) + Writing;
+		stats->written = Written;
+		stats->skipped = Skipped;
+	}
+	stats->maxDepth = MaxDepth;
+	stats->rejected = Rejected;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file Eeprom.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Interrupt-driven EEPROM write queue.
+ *
+ * An EEPROM byte write takes about 8.5 ms on the ATmega32, and the
+ * avr-libc eeprom_write_* and eeprom_update_* routines busy-wait for
+ * every byte. Eeprom_Write() only
+ * queues the byte in RAM; the EE_RDY interrupt writes the queue out one
+ * byte per interrupt, in order, and skips bytes that already hold the
+ * value, so nothing in the main loop ever waits for the EEPROM.
+ *
+ * Writes are retired in the order they were queued, so a sequence that is
+ * written in a crash-safe order keeps that order on the chip.
+ *
+ * Read with Eeprom_Read() and Eeprom_ReadBlock(), not eeprom_read_*: the
+ * EE_RDY interrupt sets EEAR for every byte it checks or writes, so it must
+ * not run in the middle of a read. Reads wait for the byte being written
+ * (at most one write time) and see the EEPROM contents, not the queued
+ * bytes; call Eeprom_Flush() first where that matters.
+ */
+
+#include "DEFS.h"
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+/** @brief Queued byte writes (power of two, at most 128). */
+#define EEPROM_QUEUE_SIZE 64
+
+#if (EEPROM_QUEUE_SIZE & (EEPROM_QUEUE_SIZE - 1)) || (EEPROM_QUEUE_SIZE > 128)
+#error "EEPROM_QUEUE_SIZE must be a power of two no larger than 128"
+#endif
+
+/**
+ * @brief Queue statistics.
+ */
+typedef struct
+{
+	uint8 depth;     /**< Bytes queued or being written now */
+	uint8 maxDepth;  /**< Largest depth since Eeprom_Init() */
+	uint16 written;  /**< Bytes written to the EEPROM */
+	uint16 skipped;  /**< Queued bytes that already held the value */
+	uint16 rejected; /**< Writes refused because the queue was full */
+} EepromStats;
+
+/**
+ * @brief Empty the queue and clear the statistics.
+ */
+void Eeprom_Init();
+
+/**
+ * @brief Queue one byte.
+ *
+ * @param address EEPROM address (e.g. of an EEMEM variable).
+ * @param value Byte to store.
+ * @return uint8 TRUE if queued, FALSE if the queue was full (counted).
+ */
+uint8 Eeprom_Write(uint8* address, uint8 value);
+
+/**
+ * @brief Queue a block, all or nothing.
+ *
+ * @param source Bytes to store.
+ * @param address EEPROM address of the first byte.
+ * @param length Number of bytes.
+ * @return uint8 TRUE if queued, FALSE if it did not fit (nothing queued, counted).
+ */
+uint8 Eeprom_WriteBlock(const void* source, void* address, uint8 length);
+
+/**
+ * @brief Read one byte with the drain interrupt held off.
+ *
+ * @param address EEPROM address.
+ * @return uint8 Byte on the chip.
+ */
+uint8 Eeprom_Read(const uint8* address);
+
+/**
+ * @brief Read a block with the drain interrupt held off.
+ *
+ * @param destination Buffer to fill.
+ * @param address EEPROM address of the first byte.
+ * @param length Number of bytes.
+ */
+void Eeprom_ReadBlock(void* destination, const void* address, uint8 length);
+
+/**
+ * @brief Free queue entries.
+ *
+ * @return uint8 Bytes that can be queued now.
+ */
+uint8 Eeprom_Free();
+
+/**
+ * @brief Mark the current end of the queue.
+ *
+ * @return uint16 Ticket for Eeprom_Done().
+ */
+uint16 Eeprom_Fence();
+
+/**
+ * @brief Check whether everything queued before a fence is on the chip.
+ *
+ * @param ticket Value returned by Eeprom_Fence() (at most 32767 writes ago).
+ * @return uint8 TRUE once every byte queued before the fence was written or skipped.
+ */
+uint8 Eeprom_Done(uint16 ticket);
+
+/**
+ * @brief Wait until the queue is empty and the last write has finished.
+ *
+ * Blocks for up to EEPROM_QUEUE_SIZE write times; meant for shutdown and
+ * start-up code, not for the main loop. Interrupts must be enabled.
+ */
+void Eeprom_Flush();
+
+/**
+ * @brief Drop the queued bytes and wait for the byte being written.
+ *
+ * For the power-fail path, which needs the EEPROM to itself: afterwards
+ * nothing more is written from the queue, and the avr-libc routines can
+ * write straight away. Call with interrupts off.
+ */
+void Eeprom_Abort();
+
+/**
+ * @brief Read the queue statistics.
+ *
+ * @param stats Pointer to the statistics to fill.
+ */
+void Eeprom_GetStats(EepromStats* stats);
+
+#endif // EEPROM_H
@@ -0,0 +1,49 @@
+/**
+ * @file EventQueue.c
+ * @brief Single-producer/single-consumer event ring buffer.
+ *
+ * Head and tail are free-running 8-bit indices: the producer only writes the
+ * head and the consumer only writes the tail, and both are single bytes so each
+ * side reads the other's index atomically. A slot is filled before the head
+ * moves past it and emptied before the tail does. The producer side,
+ * EventQueue_Push(), is inlined from EventQueue.h.
+ */
+
+#include "EventQueue.h"
+
+volatile Event g_EventQueue[EVENT_QUEUE_SIZE];
+volatile uint8 g_EventQueueHead;
+volatile uint8 g_EventQueueTail;
+volatile uint8 g_EventQueueDropped;
+
+/**
+ * @brief Takes the oldest queued event.
+ *
+ * @param event Pointer to the event to fill.
+ * @return uint8 TRUE if an event was taken, FALSE if the queue was empty.
+ */
+uint8 EventQueue_Pop(Event* event)
+{
+	uint8 tail = g_EventQueueTail;
+
+	if (tail == g_EventQueueHead)
+	{
+		return FALSE;
+	}
+
+	event->type = g_EventQueue[tail & EVENT_QUEUE_MASK].type;
+	event->arg  = g_EventQueue[tail & EVENT_QUEUE_MASK].arg;
+	g_EventQueueTail = tail + 1; // release the slot only after it is read
+
+	return TRUE;
+}
+
+/**
+ * @brief Returns the number of events dropped on a full queue.
+ *
+ * @return uint8 Drop count (saturates at 255).
+ */
+uint8 EventQueue_Dropped()
+{
+	return g_EventQueueDropped;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file EventQueue.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Lock-free event queue from interrupt handlers to the main loop.
+ *
+ * A fixed-size single-producer/single-consumer ring buffer of typed events.
+ * Interrupts on the AVR do not nest, so all ISRs together act as the single
+ * producer and the main loop is the single consumer; neither side needs to
+ * disable interrupts.
+ */
+
+#include "DEFS.h"
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+/** @brief Number of queued events (power of two, at most 128). */
+#define EVENT_QUEUE_SIZE 16
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) || (EVENT_QUEUE_SIZE > 128)
+#error "EVENT_QUEUE_SIZE must be a power of two no larger than 128"
+#endif
+
+/**
+ * @brief Event types exchanged between ISRs and the main loop.
+ */
+typedef enum
+{
+	EVENT_TICK,        /**< Timebase advanced (TIMEBASE_EVENT_HZ times per second) */
+	EVENT_RESET,       /**< Reset request (INT0) */
+	EVENT_PAUSE,       /**< Pause request (INT1) */
+	EVENT_RESUME,      /**< Resume request (INT2) */
+	EVENT_BUTTON_EDGE, /**< Debounced button edge; arg is a bitmask of port indices */
+	EVENT_CAPTURE,     /**< Edge captured on ICP1; take it with TimeBase_PopCapture() */
+	EVENT_SPLIT        /**< Split input pressed; take it with Lap_PopSplit() */
+} EventType;
+
+/**
+ * @brief A queued event.
+ */
+typedef struct
+{
+	EventType type; /**< What happened */
+	uint8 arg;      /**< Event specific argument */
+} Event;
+
+/** @brief Index mask for the free-running head and tail. */
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_SIZE - 1)
+
+/** @name Queue Storage
+ *  Defined in EventQueue.c and only exposed so that EventQueue_Push() can be
+ *  inlined into ISRs without a call; use the functions below.
+ */
+///@{
+extern volatile Event g_EventQueue[EVENT_QUEUE_SIZE];
+extern volatile uint8 g_EventQueueHead;    /**< Next slot to write (producer) */
+extern volatile uint8 g_EventQueueTail;    /**< Next slot to read (consumer) */
+extern volatile uint8 g_EventQueueDropped; /**< Events lost to a full queue */
+///@}
+
+/**
+ * @brief Queue an event (producer side, interrupt context).
+ *
+ * Inlined so that calling it from an ISR does not force a full register save.
+ *
+ * @param type Event type.
+ * @param arg Event specific argument.
+ * @return uint8 TRUE if queued, FALSE if the queue was full (the drop is counted).
+ */
+static ALWAYS_INLINE uint8 EventQueue_Push(EventType type, uint8 arg)
+{
+	uint8 head = g_EventQueueHead;
+
+	if ((uint8)(head - g_EventQueueTail) == EVENT_QUEUE_SIZE)
+	{
+		if (g_EventQueueDropped != 0xFF)
+		{
+			g_EventQueueDropped++;
+		}
+		return FALSE;
+	}
+
+	g_EventQueue[head & EVENT_QUEUE_MASK].type = type;
+	g_EventQueue[head & EVENT_QUEUE_MASK].arg  = arg;
+	g_EventQueueHead = head + 1; // publish only after the slot is written
+
+	return TRUE;
+}
+
+/**
+ * @brief Take the oldest event (consumer side, main loop).
+ *
+ * @param event Pointer to the event to fill.
+ * @return uint8 TRUE if an event was taken, FALSE if the queue was empty.
+ */
+uint8 EventQueue_Pop(Event* event);
+
+/**
+ * @brief Check for pending events without taking one (consumer side).
+ *
+ * @return uint8 TRUE if no event is queued.
+ */
+static ALWAYS_INLINE uint8 EventQueue_Empty()
+{
+	return g_EventQueueTail == g_EventQueueHead;
+}
+
+/**
+ * @brief Number of events dropped because the queue was full.
+ *
+ * @return uint8 Drop count (saturates at 255).
+ */
+uint8 EventQueue_Dropped();
+
+#endif // EVENT_QUEUE_H
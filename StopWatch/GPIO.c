@@ -7,6 +7,7 @@
  */
 
 #include "GPIO.h"
+#include <util/atomic.h>
 
 /**
  * @brief Sets the direction of a specific pin.
@@ -120,18 +121,50 @@ void WritePort(uint8 port, uint8 val)
 }
 
 /**
- * @brief Reads the current value of an entire port.
+ * @brief Writes the masked pins of a port in a single atomic store.
  * @param port Port name ('A' to 'D').
- * @return uint8 8-bit value representing the port state.
+ * @param mask Bitmask of the pins to write.
+ * @param val New levels for the masked pins.
+ */
+void WritePortMasked(uint8 port, uint8 mask, uint8 val)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		switch (port)
+		{
+		case 'A': MUSK_REG(PORTA, mask, val); break;
+		case 'B': MUSK_REG(PORTB, mask, val); break;
+		case 'C': MUSK_REG(PORTC, mask, val); break;
+		case 'D': MUSK_REG(PORTD, mask, val); break;
+		}
+	}
+}
+
+/**
+ * @brief Reads the current input levels of an entire port.
+ * @param port Port name ('A' to 'D').
+ * @return uint8 8-bit value of the port PINx register.
  */
 uint8 ReadPort(uint8 port)
 {
 	switch (port)
 	{
-	case 'A': return PORTA;
-	case 'B': return PORTB;
-	case 'C': return PORTC;
-	case 'D': return PORTD;
+	case 'A': return PINA;
+	case 'B': return PINB;
+	case 'C': return PINC;
+	case 'D': return PIND;
 	default:  return 0x00;
 	}
 }
+
+/**
+ * @brief Samples PINA..PIND back to back into a snapshot.
+ * @param snapshot Pointer to the snapshot to fill (index 0 = port A).
+ */
+void TakePortSnapshot(PortSnapshot* snapshot)
+{
+	snapshot->pins[0] = PINA;
+	snapshot->pins[1] = PINB;
+	snapshot->pins[2] = PINC;
+	snapshot->pins[3] = PIND;
+}
@@ -29,6 +29,51 @@ typedef enum
 	OUTPUT, /**< Configure pin as output */
 } Direction;
 
+/** @name Compile-time GPIO Access
+ *  Macro variants of the pin functions for ports and pins known at compile time
+ *  (e.g. the *_PORT / *_PIN macros in Application.h). The port character is
+ *  resolved by the compiler, so with optimization enabled each access compiles
+ *  to a single sbi/cbi instruction (2 cycles) and reads to sbic/sbis, instead of
+ *  a function call with a range check and a switch on the port.
+ *  @{
+ */
+
+/** @brief DDRx register of a port character ('A' to 'D'). */
+#define GPIO_DDR_REG(port)   (*((port) == 'A' ? &DDRA  : (port) == 'B' ? &DDRB  : (port) == 'C' ? &DDRC  : &DDRD))
+
+/** @brief PORTx register of a port character ('A' to 'D'). */
+#define GPIO_PORT_REG(port)  (*((port) == 'A' ? &PORTA : (port) == 'B' ? &PORTB : (port) == 'C' ? &PORTC : &PORTD))
+
+/** @brief PINx register of a port character ('A' to 'D'). */
+#define GPIO_PIN_REG(port)   (*((port) == 'A' ? &PINA  : (port) == 'B' ? &PINB  : (port) == 'C' ? &PINC  : &PIND))
+
+/** @brief Compile-time equivalent of SetPin(). */
+#define FAST_SET_PIN(port, pin, direction) \
+	((direction) == OUTPUT ? SET(GPIO_DDR_REG(port), pin) : CLEAR(GPIO_DDR_REG(port), pin))
+
+/** @brief Compile-time equivalent of WritePin(). */
+#define FAST_WRITE_PIN(port, pin, val) \
+	((val) == HIGH ? SET(GPIO_PORT_REG(port), pin) : CLEAR(GPIO_PORT_REG(port), pin))
+
+/** @brief Compile-time equivalent of ReadPin(). */
+#define FAST_READ_PIN(port, pin)       (IS_SET(GPIO_PIN_REG(port), pin) ? HIGH : LOW)
+
+/** @brief Compile-time equivalent of TogglePin(). */
+#define FAST_TOGGLE_PIN(port, pin)     TOGGLE(GPIO_PORT_REG(port), pin)
+
+/** @brief Compile-time equivalent of WritePortMasked() (caller handles atomicity). */
+#define FAST_WRITE_PORT_MASKED(port, mask, val)  MUSK_REG(GPIO_PORT_REG(port), mask, val)
+
+/** @} */
+
+/**
+ * @brief Input levels of all ports sampled at the same moment.
+ */
+typedef struct
+{
+	uint8 pins[NUM_PORTS]; /**< PINx value of each port (0 = A, 1 = B, etc.) */
+} PortSnapshot;
+
 /**
  * @brief Set the direction of a specific pin in a port.
  *
@@ -81,11 +126,30 @@ void SetPort(uint8 port, Direction direction);
 void WritePort(uint8 port, uint8 val);
 
 /**
- * @brief Read the current 8-bit value from a port.
+ * @brief Write several pins of a port at once, leaving the other pins untouched.
+ *
+ * The masked pins change together in one store, and the read-modify-write is
+ * protected against interrupts touching the same port.
+ *
+ * @param port Port number.
+ * @param mask Bitmask of the pins to write.
+ * @param val New levels for the masked pins.
+ */
+void WritePortMasked(uint8 port, uint8 mask, uint8 val);
+
+/**
+ * @brief Read the current 8-bit input levels of a port.
  *
  * @param port Port number.
- * @return uint8 Value of the port (0–255).
+ * @return uint8 Value of the port input pins (0–255).
  */
 uint8 ReadPort(uint8 port);
 
+/**
+ * @brief Sample the input pins of every port in one pass.
+ *
+ * @param snapshot Pointer to the snapshot to fill.
+ */
+void TakePortSnapshot(PortSnapshot* snapshot);
+
 #endif // GPIO_H
@@ -0,0 +1,148 @@
+/**
+ * @file Lap.c
+ * @brief Split timestamp buffer (ISR to main loop) and lap memory.
+ */
+
+#include "Lap.h"
+
+/// Split ticks, filled by Lap_Capture() and drained by the main loop
+volatile Ticks g_LapSplits[LAP_SPLIT_SIZE];
+volatile uint8 g_LapSplitHead;
+volatile uint8 g_LapSplitTail;
+volatile uint8 g_LapSplitsDropped;
+volatile uint8 g_LapSplitsUnsignalled;
+
+/// Unsignalled splits taken back by the main loop
+static uint8 SplitsRecovered;
+
+/// Split values of the newest laps, indexed by LapHead modulo LAP_MEMORY_SIZE
+static Ticks Laps[LAP_MEMORY_SIZE];
+static uint8 LapHead;
+static uint8 LapCount;
+static uint16 LapsOverwritten;
+
+/// Split before the oldest lap kept, the start of that lap
+static Ticks LapBase;
+
+/**
+ * @brief Empties the split buffer and the lap memory.
+ */
+void Lap_Init()
+{
+	g_LapSplitHead = 0;
+	g_LapSplitTail = 0;
+	g_LapSplitsDropped = 0;
+	g_LapSplitsUnsignalled = 0;
+	SplitsRecovered = 0;
+
+	Lap_Clear(0);
+}
+
+/**
+ * @brief Takes the oldest buffered split.
+ */
+uint8 Lap_PopSplit(Ticks* ticks)
+{
+	uint8 tail = g_LapSplitTail;
+
+	if (tail == g_LapSplitHead)
+	{
+		return FALSE;
+	}
+
+	*ticks = g_LapSplits[tail & (LAP_SPLIT_SIZE - 1)];
+	g_LapSplitTail = tail + 1; // release the slot only after it is read
+
+	return TRUE;
+}
+
+/**
+ * @brief Takes the oldest buffered split once per lost EVENT_SPLIT.
+ */
+uint8 Lap_PopUnsignalled(Ticks* ticks)
+{
+	if (SplitsRecovered == g_LapSplitsUnsignalled)
+	{
+		return FALSE;
+	}
+	SplitsRecovered++;
+
+	return Lap_PopSplit(ticks);
+}
+
+/**
+ * @brief Returns the split drop counter.
+ */
+uint8 Lap_SplitsDropped()
+{
+	return g_LapSplitsDropped;
+}
+
+/**
+ * @brief Appends a lap, overwriting the oldest one when full.
+ */
+void Lap_Record(Ticks split)
+{
+	if (LapCount == LAP_MEMORY_SIZE)
+	{
+		// The oldest lap leaves; its split starts the new oldest lap
+		LapBase = Laps[LapHead & (LAP_MEMORY_SIZE - 1)];
+		if (LapsOverwritten != 0xFFFF)
+		{
+			LapsOverwritten++;
+		}
+	}
+	else
+	{
+		LapCount++;
+	}
+
+	Laps[LapHead & (LAP_MEMORY_SIZE - 1)] = split;
+	LapHead++;
+}
+
+/**
+ * @brief Drops every lap.
+ */
+void Lap_Clear(Ticks start)
+{
+	LapHead = 0;
+	LapCount = 0;
+	LapsOverwritten = 0;
+	LapBase = start;
+}
+
+/**
+ * @brief Returns the number of laps kept.
+ */
+uint8 Lap_Count()
+{
+	return LapCount;
+}
+
+/**
+ * @brief Returns the split value of the lap @p age laps back.
+ */
+Ticks Lap_Split(uint8 age)
+{
+	return Laps[(uint8)(LapHead - 1 - age) & (LAP_MEMORY_SIZE - 1)];
+}
+
+/**
+ * @brief Returns the length of the lap @p age laps back.
+ */
+Ticks Lap_Time(uint8 age)
+{
+	Ticks end = Lap_Split(age);
+	Ticks start = (age + 1 < LapCount) ? Lap_Split(age + 1) : LapBase;
+
+	return (end >= start) ? end - start : start - end;
+}
+
+/**
+ * @brief Returns the overwrite counter.
+ */
+uint16 Lap_Overwritten()
+{
+	return LapsOverwritten;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file Lap.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Split capture and lap memory.
+ *
+ * Two ring buffers:
+ * - Splits: tick timestamps written by Lap_Capture() from interrupt
+ *   context at O(1) cost and drained by the main loop. Its size only has
+ *   to cover the splits that can arrive between two main loop passes.
+ * - Laps: stopwatch values at the splits, kept for recall. When it is
+ *   full the oldest lap is overwritten.
+ *
+ * Both overflows are counted.
+ */
+
+#include "TimeBase.h"
+
+#ifndef LAP_H
+#define LAP_H
+
+/** @brief Split timestamps buffered for the main loop (power of two). */
+#define LAP_SPLIT_SIZE 16
+
+/** @brief Laps kept for recall (power of two). */
+#define LAP_MEMORY_SIZE 32
+
+#if (LAP_SPLIT_SIZE & (LAP_SPLIT_SIZE - 1)) || (LAP_MEMORY_SIZE & (LAP_MEMORY_SIZE - 1))
+#error "LAP_SPLIT_SIZE and LAP_MEMORY_SIZE must be powers of two"
+#endif
+
+/**
+ * @brief Empty both buffers and clear the overflow counters.
+ *
+ * Call before the interrupt that calls Lap_Capture() is enabled.
+ */
+void Lap_Init();
+
+/** @name Split Buffer Storage
+ *  Defined in Lap.c and only exposed so that Lap_Capture() can be inlined
+ *  into the display ISR without a call; use the functions below.
+ */
+///@{
+extern volatile Ticks g_LapSplits[LAP_SPLIT_SIZE];
+extern volatile uint8 g_LapSplitHead;         /**< Next slot to write (ISR) */
+extern volatile uint8 g_LapSplitTail;         /**< Next slot to read (main loop) */
+extern volatile uint8 g_LapSplitsDropped;     /**< Splits lost to a full buffer */
+extern volatile uint8 g_LapSplitsUnsignalled; /**< Splits whose EVENT_SPLIT was dropped */
+///@}
+
+/**
+ * @brief Timestamp a split and queue EVENT_SPLIT (interrupt context).
+ *
+ * A split that finds the buffer full is dropped and counted. Inlined, like
+ * EventQueue_Push(), so the calling ISR does not save every register.
+ */
+static ALWAYS_INLINE void Lap_Capture()
+{
+	uint8 head = g_LapSplitHead;
+	if ((uint8)(head - g_LapSplitTail) == LAP_SPLIT_SIZE)
+	{
+		if (g_LapSplitsDropped != 0xFF)
+		{
+			g_LapSplitsDropped++;
+		}
+		return;
+	}
+	g_LapSplits[head & (LAP_SPLIT_SIZE - 1)] = TimeBase_NowFromISR();
+	g_LapSplitHead = head + 1; // publish only after the slot is written
+
+	if (!EventQueue_Push(EVENT_SPLIT, 0))
+	{
+		g_LapSplitsUnsignalled++;
+	}
+}
+
+/**
+ * @brief Take the oldest buffered split.
+ *
+ * @param ticks Pointer to the tick of the split to fill.
+ * @return uint8 TRUE if a split was taken, FALSE if none is buffered.
+ */
+uint8 Lap_PopSplit(Ticks* ticks);
+
+/**
+ * @brief Take the oldest buffered split if an EVENT_SPLIT was lost to a full event queue.
+ *
+ * Take one split per EVENT_SPLIT with Lap_PopSplit() and call this on
+ * EVENT_TICK until it returns FALSE to catch up on the splits left behind.
+ *
+ * @param ticks Pointer to the tick of the split to fill.
+ * @return uint8 TRUE if a split was taken, FALSE if no event was lost.
+ */
+uint8 Lap_PopUnsignalled(Ticks* ticks);
+
+/**
+ * @brief Number of splits lost to a full split buffer.
+ *
+ * @return uint8 Drop count, saturating at 255.
+ */
+uint8 Lap_SplitsDropped();
+
+/**
+ * @brief Store the stopwatch value at a split as the newest lap.
+ *
+ * @param split Stopwatch value at the split, in ticks.
+ */
+void Lap_Record(Ticks split);
+
+/**
+ * @brief Forget all laps (the split buffer is kept).
+ *
+ * @param start Stopwatch value the first lap starts from, in ticks.
+ */
+void Lap_Clear(Ticks start);
+
+/**
+ * @brief Number of laps available for recall.
+ *
+ * @return uint8 0 to LAP_MEMORY_SIZE.
+ */
+uint8 Lap_Count();
+
+/**
+ * @brief Stopwatch value at a recorded split.
+ *
+ * @param age 0 for the newest lap, up to Lap_Count() - 1.
+ * @return Ticks Split value.
+ */
+Ticks Lap_Split(uint8 age);
+
+/**
+ * @brief Duration of a recorded lap.
+ *
+ * The difference between its split and the one before (the start given
+ * to Lap_Clear() for the first lap); counting down gives the same
+ * positive duration.
+ *
+ * @param age 0 for the newest lap, up to Lap_Count() - 1.
+ * @return Ticks Lap duration.
+ */
+Ticks Lap_Time(uint8 age);
+
+/**
+ * @brief Number of laps overwritten because the lap memory was full.
+ *
+ * @return uint16 Overwrite count since the last Lap_Clear(), saturating at 65535.
+ */
+uint16 Lap_Overwritten();
+
+#endif // LAP_H
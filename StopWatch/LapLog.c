@@ -0,0 +1,248 @@
+/**
+ * @file LapLog.c
+ * @brief Writer and boot-time scanner of the EEPROM lap log.
+ */
+
+#include "LapLog.h"
+#include "Eeprom.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+/// Queue entries an append can take: pending header, wrap header and record, each with 2 markers
+#define LAPLOG_APPEND_QUEUE (2 * (LAPLOG_HEADER_SIZE + 2) + LAPLOG_RECORD_MAX + 2)
+
+#if LAPLOG_APPEND_QUEUE > EEPROM_QUEUE_SIZE
+#error "EEPROM_QUEUE_SIZE cannot hold a lap log append"
+#endif
+
+/// Log region
+static EEMEM uint8 LapLogImage[LAPLOG_SIZE];
+
+/// Offset of the LAPLOG_END byte that ends the log
+static uint16 End;
+
+/// Session being logged
+static uint16 Session;
+
+/// TRUE when the next lap has to write a session header first
+static uint8 HeaderPending;
+
+/// Laps that could not be queued for writing
+static uint16 Dropped;
+
+/// Split and lap of the last entry, in hundredths (the session start and 0 after a header)
+static int32 LastSplit;
+static int32 LastLap;
+
+/**
+ * @brief CRC-8 of the header bytes after the marker.
+ */
+static uint8 HeaderCrc(const uint8* body)
+{
+	uint8 crc = 0;
+	for (uint8 i = 0; i < LAPLOG_HEADER_SIZE - 2; i++)
+	{
+		crc = _crc8_ccitt_update(crc, body[i]);
+	}
+	return crc;
+}
+
+/**
+ * @brief Queues an entry at End and moves End past it.
+ *
+ * The lead byte is invalidated first and written last, after the new end
+ * marker; the write queue keeps that order, so the log stays readable if
+ * the writes are interrupted. Takes length + 2 queue entries, which the
+ * caller has checked for.
+ *
+ * @param entry Entry bytes, lead first.
+ * @param length Number of bytes (End + length < LAPLOG_SIZE).
+ */
+static void WriteEntry(const uint8* entry, uint8 length)
+{
+	Eeprom_Write(&LapLogImage[End], LAPLOG_END);
+	Eeprom_WriteBlock(&entry[1], &LapLogImage[End + 1], length - 1);
+	Eeprom_Write(&LapLogImage[End + length], LAPLOG_END);
+	Eeprom_Write(&LapLogImage[End], entry[0]);
+
+	End += length;
+}
+
+/**
+ * @brief Writes a session header, restarting the log at its beginning when
+ * the header and a record do not fit.
+ */
+static void WriteHeader()
+{
+	if (End + LAPLOG_HEADER_SIZE + LAPLOG_RECORD_MAX >= LAPLOG_SIZE)
+	{
+		End = 0;
+	}
+
+	uint8 header[LAPLOG_HEADER_SIZE];
+	header[0] = LAPLOG_HEADER;
+	header[1] = LAPLOG_VERSION;
+	header[2] = (uint8)Session;
+	header[3] = (uint8)(Session >> 8);
+	header[4] = (uint8)LastSplit;
+	header[5] = (uint8)(LastSplit >> 8);
+	header[6] = (uint8)(LastSplit >> 16);
+	header[7] = (uint8)(LastSplit >> 24);
+	header[8] = HeaderCrc(&header[1]);
+
+	WriteEntry(header, LAPLOG_HEADER_SIZE);
+	LastLap = 0;
+	HeaderPending = FALSE;
+}
+
+/**
+ * @brief Walks the log from the start to its end marker.
+ *
+ * A torn or corrupt entry ends the log there; the next write overwrites it.
+ */
+void LapLog_Init()
+{
+	uint16 offset = 0;
+	Session = 0;
+	Dropped = 0;
+
+	while (offset < LAPLOG_SIZE)
+	{
+		uint8 lead = Eeprom_Read(&LapLogImage[offset]);
+		uint8 length;
+
+		if (lead == LAPLOG_HEADER && offset + LAPLOG_HEADER_SIZE < LAPLOG_SIZE)
+		{
+			uint8 header[LAPLOG_HEADER_SIZE];
+			Eeprom_ReadBlock(header, &LapLogImage[offset], LAPLOG_HEADER_SIZE);
+			if (header[1] != LAPLOG_VERSION || header[8] != HeaderCrc(&header[1]))
+			{
+				break;
+			}
+			Session = header[2] | ((uint16)header[3] << 8);
+			length = LAPLOG_HEADER_SIZE;
+		}
+		else if (lead < LAPLOG_FIRST_RESERVED)
+		{
+			length = LAPLOG_RECORD_LENGTH(lead);
+		}
+		else
+		{
+			break;
+		}
+
+		if (offset + length >= LAPLOG_SIZE)
+		{
+			break;
+		}
+		offset += length;
+	}
+
+	// The end marker is (re)written with the next entry
+	End = offset;
+	LapLog_Begin(0);
+}
+
+/**
+ * @brief Defers a new session header to the next lap.
+ */
+void LapLog_Begin(Ticks start)
+{
+	if (!HeaderPending)
+	{
+		Session++;
+		HeaderPending = TRUE;
+	}
+	LastSplit = (int32)TimeBase_Hundredths(start);
+}
+
+/**
+ * @brief Encodes zigzag(@p delta) as a prefix varint.
+ *
+ * @param delta Difference to the previous lap, in hundredths.
+ * @param record Buffer of LAPLOG_RECORD_MAX bytes to fill.
+ * @return uint8 Record length in bytes.
+ */
+static uint8 Encode(int32 delta, uint8* record)
+{
+	uint32 value = LAPLOG_ZIGZAG(delta);
+
+	if (value < 0x80UL)
+	{
+		record[0] = (uint8)value;
+		return 1;
+	}
+	if (value < 0x4000UL)
+	{
+		record[0] = 0x80 | (uint8)(value >> 8);
+		record[1] = (uint8)value;
+		return 2;
+	}
+	if (value < 0x200000UL)
+	{
+		record[0] = 0xC0 | (uint8)(value >> 16);
+		record[1] = (uint8)(value >> 8);
+		record[2] = (uint8)value;
+		return 3;
+	}
+	record[0] = 0xE0 | (uint8)((value >> 24) & 0x0F);
+	record[1] = (uint8)(value >> 16);
+	record[2] = (uint8)(value >> 8);
+	record[3] = (uint8)value;
+	return 4;
+}
+
+/**
+ * @brief Appends the lap as the difference to the previous lap.
+ */
+void LapLog_Append(Ticks split)
+{
+	int32 hundredths = (int32)TimeBase_Hundredths(split);
+	int32 lap = hundredths - LastSplit;
+	uint8 record[LAPLOG_RECORD_MAX];
+
+	// Queue too full for the worst case: skip the lap and restart the deltas at its split
+	if (Eeprom_Free() < LAPLOG_APPEND_QUEUE)
+	{
+		HeaderPending = TRUE;
+		LastSplit = hundredths;
+		if (Dropped != 0xFFFF)
+		{
+			Dropped++;
+		}
+		return;
+	}
+
+	if (HeaderPending)
+	{
+		WriteHeader();
+	}
+
+	uint8 length = Encode(lap - LastLap, record);
+	if (End + length >= LAPLOG_SIZE)
+	{
+		// No room for the record and its end marker: continue the session from the start
+		WriteHeader();
+		length = Encode(lap, record);
+	}
+
+	WriteEntry(record, length);
+	LastSplit = hundredths;
+	LastLap = lap;
+}
+
+/**
+ * @brief Returns the drop counter.
+ */
+uint16 LapLog_Dropped()
+{
+	return Dropped;
+}
+
+/**
+ * @brief Returns the current session number.
+ */
+uint16 LapLog_Session()
+{
+	return Session;
+}
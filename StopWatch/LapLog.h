@@ -0,0 +1,70 @@
+/**
+ * @file LapLog.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Append-only lap history in EEPROM.
+ *
+ * Every recorded lap is appended to a delta-encoded log (see
+ * LapLogFormat.h), so typical laps take one or two bytes instead of the
+ * three of a Time struct or the four of a tick count. A session starts at
+ * the first lap after power-up, reset, a time adjustment or a direction
+ * change; its header carries a session number that increases across power
+ * cycles.
+ *
+ * Read a dump (avrdude -U eeprom:r:eeprom.bin:r) back with
+ * Tools/LapLogDecode.c.
+ */
+
+#include "TimeBase.h"
+#include "LapLogFormat.h"
+
+#ifndef LAP_LOG_H
+#define LAP_LOG_H
+
+/** @brief EEPROM bytes reserved for the log (of the 1024 of the ATmega32). */
+#define LAPLOG_SIZE 768
+
+/**
+ * @brief Find the end of the log and the last session number.
+ *
+ * Reads the EEPROM with Eeprom_ReadBlock(), so writes queued before it
+ * (a new calibration) may still be draining. Call it before the log is
+ * written. The next lap starts a new session.
+ */
+void LapLog_Init();
+
+/**
+ * @brief Start a new session at the next lap.
+ *
+ * Nothing is written until that lap.
+ *
+ * @param start Stopwatch value the first lap runs from, in ticks.
+ */
+void LapLog_Begin(Ticks start);
+
+/**
+ * @brief Append a lap.
+ *
+ * Only queues the bytes (see Eeprom.h). When the write queue is too full
+ * the lap is left out and counted; the log resynchronizes with a session
+ * header (same session number) at the next lap.
+ *
+ * @param split Stopwatch value at the split, in ticks.
+ */
+void LapLog_Append(Ticks split);
+
+/**
+ * @brief Number of laps left out because the EEPROM write queue was full.
+ *
+ * @return uint16 Drop count, saturating at 65535.
+ */
+uint16 LapLog_Dropped();
+
+/**
+ * @brief Number of the session being logged (or to be logged next).
+ *
+ * @return uint16 Session number.
+ */
+uint16 LapLog_Session();
+
+#endif // LAP_LOG_H
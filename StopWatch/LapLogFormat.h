@@ -0,0 +1,61 @@
+/**
+ * @file LapLogFormat.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief On-EEPROM lap log format, shared with the host decoder.
+ *
+ * The log is a byte sequence that starts at the beginning of the region:
+ *
+ *     session header, record, record, ..., session header, record, ..., 0xFF
+ *
+ * Session header (LAPLOG_HEADER_SIZE bytes):
+ *
+ *     LAPLOG_HEADER, LAPLOG_VERSION, session (2 bytes, LE),
+ *     start (4 bytes, LE), CRC-8 of the 7 bytes after the marker
+ *
+ * where start is the stopwatch value the first lap runs from, in hundredths
+ * of a second. The CRC is CRC-8/CCITT (polynomial 0x07, initial 0).
+ *
+ * Each record is one lap. With lap(0) = 0 at the header, split(0) = start
+ * and lap(n) = split(n) - split(n - 1) (negative when counting down), a
+ * record holds zigzag(lap(n) - lap(n - 1)) as a prefix varint, most
+ * significant bits first:
+ *
+ *     0xxxxxxx                     7 bits
+ *     10xxxxxx xxxxxxxx            14 bits
+ *     110xxxxx xxxxxxxx xxxxxxxx   21 bits
+ *     1110xxxx + 3 bytes           28 bits
+ *
+ * Lead bytes 0xF0 and up are not records: LAPLOG_HEADER starts a session
+ * and LAPLOG_END (erased EEPROM) ends the log. Equal laps cost one byte,
+ * laps within +-0.63 s of the previous one too, and any lap below 27 h at
+ * most four bytes.
+ *
+ * Writers store the lead (or header marker) byte last and LAPLOG_END after
+ * the new entry before it, so an interrupted write leaves the log ending
+ * just before the torn entry. When the region is full the log restarts at
+ * its beginning with a header that continues the same session.
+ */
+
+#ifndef LAP_LOG_FORMAT_H
+#define LAP_LOG_FORMAT_H
+
+#define LAPLOG_END 0xFF              /**< Erased byte, end of the log */
+#define LAPLOG_HEADER 0xF8           /**< Session header marker */
+#define LAPLOG_FIRST_RESERVED 0xF0   /**< Lowest lead byte that is not a record */
+#define LAPLOG_VERSION 1
+#define LAPLOG_HEADER_SIZE 9
+#define LAPLOG_RECORD_MAX 4          /**< Longest record in bytes */
+#define LAPLOG_UNITS_PER_SECOND 100  /**< Laps are stored in hundredths */
+
+/** @brief Record length in bytes from its lead byte (below LAPLOG_FIRST_RESERVED). */
+#define LAPLOG_RECORD_LENGTH(lead) \
+	(((lead) & 0x80) == 0 ? 1 : ((lead) & 0xC0) == 0x80 ? 2 : ((lead) & 0xE0) == 0xC0 ? 3 : 4)
+
+/** @brief Zigzag mapping of a signed difference to an unsigned value (0, -1, 1, -2 ... to 0, 1, 2, 3 ...). */
+#define LAPLOG_ZIGZAG(d) ((((unsigned long)(d)) << 1) ^ (unsigned long)((d) < 0 ? -1L : 0L))
+
+/** @brief Inverse of LAPLOG_ZIGZAG(). */
+#define LAPLOG_UNZIGZAG(z) ((long)((z) >> 1) ^ -(long)((z) & 1))
+
+#endif // LAP_LOG_FORMAT_H
@@ -32,6 +32,16 @@ typedef struct
 	LedType type;   /**< Logic type (positive or negative) */
 } Led;
 
+/** @name Compile-time LED Access
+ *  For LEDs whose port, pin and logic type are compile-time constants.
+ *  Each expands to a single sbi/cbi (see FAST_WRITE_PIN in GPIO.h).
+ *  @{
+ */
+#define LED_ON(port, pin, type)   FAST_WRITE_PIN(port, pin, (type) == POSITIVE_LOGIC ? HIGH : LOW)
+#define LED_OFF(port, pin, type)  FAST_WRITE_PIN(port, pin, (type) == POSITIVE_LOGIC ? LOW : HIGH)
+#define LED_TOGGLE(port, pin)     FAST_TOGGLE_PIN(port, pin)
+/** @} */
+
 /**
  * @brief Initialize an LED with given port, pin, and logic type.
  *
@@ -0,0 +1,232 @@
+/**
+ * @file Persist.c
+ * @brief EEPROM record ring for the stopwatch state and its save policy.
+ */
+
+#include "Persist.h"
+#include "Eeprom.h"
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+
+/** @name Record Flags */
+///@{
+#define PERSIST_INCREMENTAL 0x01 /**< Counting up */
+#define PERSIST_RUNNING     0x02 /**< Running when saved */
+///@}
+
+/**
+ * @brief One slot of the ring.
+ */
+typedef struct
+{
+	uint16 sequence; /**< Save number, increasing (with wrap-around) */
+	Ticks value;     /**< Stopwatch value in ticks */
+	uint8 flags;     /**< PERSIST_* flags */
+	uint8 crc;       /**< CRC-8 of the bytes before it; erased slots fail */
+} PersistRecord;
+
+/// Record ring
+static EEMEM PersistRecord Ring[PERSIST_SLOTS];
+
+/// Record written by the power-fail interrupt, invalidated once restored
+static EEMEM PersistRecord Emergency;
+
+/// Slot the next save goes to, and its sequence number
+static uint8 NextSlot;
+static uint16 NextSequence;
+
+/// Contents of the last record saved or restored
+static Ticks SavedValue;
+static uint8 SavedFlags;
+static uint8 SavedValid;
+
+static uint16 Saves;
+
+/// Periodic save, adjustment settle delay (and retry after a full queue)
+static SoftTimer PeriodTimer;
+static SoftTimer SettleTimer;
+
+/**
+ * @brief CRC-8 of a record without its crc field.
+ */
+static uint8 RecordCrc(const PersistRecord* record)
+{
+	const uint8* bytes = (const uint8*)record;
+	uint8 length = (uint8)(&record->crc - bytes);
+	uint8 crc = 0;
+	for (uint8 i = 0; i < length; i++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[i]);
+	}
+	return crc;
+}
+
+/**
+ * @brief Timer callback: saves the state.
+ */
+static void SaveCallback(void* context)
+{
+	Persist_Save();
+}
+
+/**
+ * @brief Finds the newest valid record, restores it and picks the slot after it.
+ */
+void Persist_Init()
+{
+	PersistRecord newest = { 0 }; // only read once found is set, but the compiler cannot tell
+	uint8 found = FALSE;
+
+	NextSlot = 0;
+	for (uint8 slot = 0; slot < PERSIST_SLOTS; slot++)
+	{
+		PersistRecord record;
+		Eeprom_ReadBlock(&record, &Ring[slot], sizeof(record));
+
+		if (record.crc != RecordCrc(&record))
+		{
+			continue;
+		}
+		// All valid sequences lie within PERSIST_SLOTS of each other
+		if (!found || (int16)(record.sequence - newest.sequence) > 0)
+		{
+			newest = record;
+			NextSlot = (slot + 1 == PERSIST_SLOTS) ? 0 : slot + 1;
+			found = TRUE;
+		}
+	}
+
+	// A power-fail record is newer than the ring unless a save followed it
+	PersistRecord emergency;
+	uint8 emergencyValid = FALSE;
+	uint8 running = FALSE;
+	Eeprom_ReadBlock(&emergency, &Emergency, sizeof(emergency));
+	if (emergency.crc == RecordCrc(&emergency))
+	{
+		emergencyValid = TRUE;
+		if (!found || (int16)(emergency.sequence - newest.sequence) > 0)
+		{
+			newest = emergency;
+			running = (emergency.flags & PERSIST_RUNNING) != 0;
+			found = TRUE;
+		}
+	}
+
+	SavedValid = found;
+	NextSequence = 0;
+	if (found)
+	{
+		StopWatchState state;
+		state.value = newest.value;
+		state.mode = (newest.flags & PERSIST_INCREMENTAL) ? INCREMENTAL_MODE : DECREMENTAL_MODE;
+		state.running = running;
+		StopWatch_SetState(&state);
+
+		NextSequence = newest.sequence + 1;
+		SavedValue = newest.value;
+		SavedFlags = newest.flags;
+	}
+
+	Saves = 0;
+	SoftTimer_Init(&SettleTimer, SaveCallback, NULL);
+	SoftTimer_Init(&PeriodTimer, SaveCallback, NULL);
+	SoftTimer_Start(&PeriodTimer, MS_TO_TICKS(PERSIST_PERIOD_MIN * 60000UL), MS_TO_TICKS(PERSIST_PERIOD_MIN * 60000UL));
+
+	// The emergency slot is used once: its state moves to the ring before the slot is invalidated
+	if (emergencyValid)
+	{
+		SavedValid = FALSE;
+		Persist_Save();
+		Eeprom_Write(&Emergency.crc, (uint8)~emergency.crc);
+	}
+}
+
+/**
+ * @brief Queues a record into the next slot if the state changed.
+ */
+void Persist_Save()
+{
+	StopWatchState state;
+	StopWatch_GetState(&state);
+
+	PersistRecord record;
+	record.sequence = NextSequence;
+	record.value = state.value;
+	record.flags = ((state.mode == INCREMENTAL_MODE) ? PERSIST_INCREMENTAL : 0) |
+	               (state.running ? PERSIST_RUNNING : 0);
+	record.crc = RecordCrc(&record);
+
+	if (SavedValid && record.value == SavedValue && record.flags == SavedFlags)
+	{
+		SoftTimer_Cancel(&SettleTimer);
+		return;
+	}
+
+	if (!Eeprom_WriteBlock(&record, &Ring[NextSlot], sizeof(record)))
+	{
+		SoftTimer_Start(&SettleTimer, MS_TO_TICKS(PERSIST_RETRY_MS), 0);
+		return;
+	}
+	SoftTimer_Cancel(&SettleTimer);
+
+	NextSlot = (NextSlot + 1 == PERSIST_SLOTS) ? 0 : NextSlot + 1;
+	NextSequence++;
+	SavedValue = record.value;
+	SavedFlags = record.flags;
+	SavedValid = TRUE;
+	Saves++;
+}
+
+/**
+ * @brief Writes the record straight to the emergency slot, crc last.
+ */
+void Persist_Emergency()
+{
+	StopWatchState state;
+	StopWatch_GetState(&state);
+
+	PersistRecord record;
+	record.sequence = NextSequence++;
+	record.value = state.value;
+	record.flags = ((state.mode == INCREMENTAL_MODE) ? PERSIST_INCREMENTAL : 0) |
+	               (state.running ? PERSIST_RUNNING : 0);
+	record.crc = RecordCrc(&record);
+
+	// The slot was invalidated at boot, so it stays invalid until the crc lands
+	Eeprom_Abort();
+	eeprom_update_block(&record, &Emergency, (uint8)(&record.crc - (uint8*)&record));
+	eeprom_update_byte(&Emergency.crc, record.crc);
+}
+
+/**
+ * @brief Restarts the settle delay.
+ */
+void Persist_Changed()
+{
+	SoftTimer_Start(&SettleTimer, MS_TO_TICKS(PERSIST_SETTLE_MS), 0);
+}
+
+/**
+ * @brief Saves on pause and reset.
+ */
+void Persist_HandleEvent(const Event* event)
+{
+	switch (event->type)
+	{
+	case EVENT_PAUSE:
+	case EVENT_RESET:
+		Persist_Save();
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Returns the save counter.
+ */
+uint16 Persist_Saves()
+{
+	return Saves;
+}
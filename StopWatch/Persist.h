@@ -0,0 +1,107 @@
+/**
+ * @file Persist.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Wear-leveled, power-fail-safe storage of the stopwatch state.
+ *
+ * The state (value, count direction, running flag) is saved as an 8-byte
+ * record with a sequence number and a CRC-8. Each save goes to the next
+ * of PERSIST_SLOTS slots of an EEPROM ring, so the previous record is
+ * never overwritten by the save in progress: a save torn by a power
+ * failure fails its CRC and the boot scan falls back to the record
+ * before it.
+ *
+ * Saves are batched by policy:
+ * - immediately on pause, reset and mode change;
+ * - PERSIST_SETTLE_MS after the last time adjustment, so holding an
+ *   adjustment button costs one save, not one per step;
+ * - every PERSIST_PERIOD_MIN minutes while the value changes (running).
+ * A save whose state equals the last saved one writes nothing.
+ *
+ * Cell lifetime: every save writes each byte of one slot at most once, so
+ * a cell is written once per PERSIST_SLOTS saves. With the periodic save
+ * as the steady load, a cell sees one write every
+ * PERSIST_SLOTS * PERSIST_PERIOD_MIN minutes, and reaches the datasheet
+ * endurance of EEPROM_ENDURANCE cycles after PERSIST_LIFETIME_DAYS days
+ * (about 57 years with the defaults). Pauses, resets and mode changes add
+ * to that load: 30 of them an hour, around the clock, still leave about
+ * 9.5 years. A naive save every second to one location would last 28
+ * hours.
+ *
+ * After a power cycle the state is restored paused, since the time spent
+ * without power is unknown. The exception is a power failure caught by
+ * the supply monitor (see Power.h): Persist_Emergency() writes the state of
+ * that instant to a slot of its own, and a stopwatch that was running then
+ * resumes counting from it at the next boot. Once restored, the state is
+ * copied to the ring and the slot invalidated, so each of its cells sees
+ * at most two writes per power cycle.
+ */
+
+#include "Application.h"
+#include "Scheduler.h"
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+/** @name Persistence Configuration */
+///@{
+#define PERSIST_SLOTS 30            /**< Records in the EEPROM ring (8 bytes each) */
+#define PERSIST_PERIOD_MIN 10       /**< Periodic save interval, minutes */
+#define PERSIST_SETTLE_MS 5000      /**< Quiet time after an adjustment before it is saved */
+#define PERSIST_RETRY_MS 100        /**< Retry delay when the EEPROM queue is full */
+#define PERSIST_EMERGENCY_MS 77     /**< Worst-case Persist_Emergency() time: 9 writes of 8.5 ms */
+#define EEPROM_ENDURANCE 100000UL   /**< Write/erase cycles per cell (ATmega32 datasheet) */
+#define PERSIST_MIN_LIFETIME_DAYS 3650UL
+
+#define PERSIST_LIFETIME_DAYS (EEPROM_ENDURANCE * PERSIST_SLOTS * PERSIST_PERIOD_MIN / (24UL * 60))
+
+#if PERSIST_LIFETIME_DAYS < PERSIST_MIN_LIFETIME_DAYS
+#error "PERSIST_SLOTS and PERSIST_PERIOD_MIN wear the EEPROM out in less than PERSIST_MIN_LIFETIME_DAYS"
+#endif
+///@}
+
+/**
+ * @brief Restore the newest valid record and start the periodic save.
+ *
+ * Requires StopWatch_Init(), Eeprom_Init() and Scheduler_Init(). Reads the
+ * EEPROM with Eeprom_ReadBlock(), so call it before the ring is written;
+ * other queued writes may still be draining.
+ */
+void Persist_Init();
+
+/**
+ * @brief Save the state now, unless it is unchanged since the last save.
+ *
+ * Only queues the bytes (see Eeprom.h); retried shortly when the queue is full.
+ */
+void Persist_Save();
+
+/**
+ * @brief Note a time adjustment; the state is saved once adjustments settle.
+ */
+void Persist_Changed();
+
+/**
+ * @brief Apply the save policy to an event handled by StopWatch_HandleEvent().
+ *
+ * @param event Pointer to the event taken from the event queue.
+ */
+void Persist_HandleEvent(const Event* event);
+
+/**
+ * @brief Write the current state to the emergency slot, bypassing the queue.
+ *
+ * Called by the power-fail interrupt with interrupts off. Drops the EEPROM
+ * queue and busy-waits for each byte that differs from the slot, the crc
+ * last: at most one write in progress plus 8 bytes, PERSIST_EMERGENCY_MS.
+ */
+void Persist_Emergency();
+
+/**
+ * @brief Number of records saved since power-up.
+ *
+ * @return uint16 Save count.
+ */
+uint16 Persist_Saves();
+
+#endif // PERSIST_H
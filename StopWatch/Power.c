@@ -0,0 +1,109 @@
+/**
+ * @file Power.c
+ * @brief Idle sleep between events and the power-fail emergency save.
+ */
+
+#include "Power.h"
+#include "Persist.h"
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#if POWER_FAIL_DETECT
+/**
+ * @brief Analog Comparator ISR: the supply is failing.
+ * Sheds the load, saves the state and never returns: either the power dies
+ * or, once the supply has recovered, the watchdog restarts the MCU.
+ */
+ISR(ANA_COMP_vect)
+{
+	// Every milliamp saved stretches the hold-up time
+	Timer0_OFF();
+	CLEAR_REG(SEVEN_SEGMENT_MULT_PORT, SEVEN_SEGMENT_MULT_PIN);
+	LED_OFF(COUNT_UP_LED_PORT, COUNT_UP_LED_PIN, COUNT_UP_LED_TYPE);
+	LED_OFF(COUNT_DOWN_LED_PORT, COUNT_DOWN_LED_PIN, COUNT_DOWN_LED_TYPE);
+#if TONE_HARDWARE
+	Timer2_Toggle_Stop();
+#endif
+	FAST_WRITE_PIN(BUZZER_PORT, BUZZER_PIN, LOW);
+
+	Persist_Emergency();
+
+	// The comparator has no hysteresis: wait for the supply to stay good
+	uint8 good = 0;
+	while (good < POWER_FAIL_RECOVER_MS)
+	{
+		_delay_ms(1);
+		good = IS_SET(ACSR, ACO) ? 0 : good + 1;
+	}
+	wdt_enable(WDTO_15MS);
+	while (1)
+	{
+	}
+}
+#endif
+
+/**
+ * @brief Disables the ADC; arms the comparator on the supply divider or turns it off.
+ */
+void Power_Init()
+{
+	CLEAR(ADCSRA, ADEN);
+
+	// ACIE is clear after reset, so reconfiguring the comparator raises no interrupt
+	CLEAR(ACSR, ACIE);
+#if POWER_FAIL_DETECT
+	// Sense input without pull-up; the multiplexer feeds it to the comparator while the ADC is off
+	FAST_SET_PIN(POWER_FAIL_PORT, POWER_FAIL_PIN, INPUT);
+	FAST_WRITE_PIN(POWER_FAIL_PORT, POWER_FAIL_PIN, LOW);
+	ADMUX = POWER_FAIL_MUX;
+	SET(SFIOR, ACME);
+
+	// Bandgap on the positive input; ACO rises when the divided supply falls below it
+	ACSR = (1 << ACBG) | (1 << ACIS1) | (1 << ACIS0);
+	_delay_us(70);          // bandgap start-up
+	SET(ACSR, ACI);         // discard an edge seen while it settled (written one clears it)
+	SET(ACSR, ACIE);
+#else
+	SET(ACSR, ACD);
+#endif
+
+#ifdef WAKE_PROFILE
+	FAST_SET_PIN(WAKE_PROFILE_PORT, WAKE_PROFILE_PIN, OUTPUT);
+#endif
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+/**
+ * @brief Sleeps until an event is pending; interrupts that queue nothing put the CPU straight back to sleep.
+ */
+void Power_Idle()
+{
+	cli();
+	if (EventQueue_Empty())
+	{
+		do
+		{
+			sleep_enable();
+			sei();       // takes effect after the next instruction, so no wakeup slips in before the sleep
+			sleep_cpu();
+			sleep_disable();
+			cli();
+		} while (EventQueue_Empty());
+
+#ifdef WAKE_PROFILE
+		FAST_WRITE_PIN(WAKE_PROFILE_PORT, WAKE_PROFILE_PIN, HIGH);
+#endif
+	}
+	sei();
+}
+
+/**
+ * @brief Ends the wake profiling pulse.
+ */
+void Power_Serviced()
+{
+#ifdef WAKE_PROFILE
+	FAST_WRITE_PIN(WAKE_PROFILE_PORT, WAKE_PROFILE_PIN, LOW);
+#endif
+}
@@ -0,0 +1,109 @@
+/**
+ * @file Power.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Sleep between events and power down unused peripherals.
+ *
+ * The main loop sleeps in SLEEP_MODE_IDLE whenever the event queue is empty.
+ * Idle is the deepest mode available: the digits are multiplexed by the
+ * Timer0 interrupt, which needs the I/O clock, so power-save would blank the
+ * display even with the Timer2 watch crystal timebase.
+ *
+ * Wake-up: idle has no oscillator start-up time, so an interrupt is taken
+ * 4 cycles after its source fires plus the usual 4-cycle interrupt
+ * response, about 0.5 us at 16 MHz. The main loop then services the event
+ * as soon as the ISR returns. Define WAKE_PROFILE to drive
+ * WAKE_PROFILE_PIN high from wake-up until the queue is drained again; the
+ * time from a button or timer edge to the falling edge of that pin is the
+ * wake-to-service latency.
+ *
+ * Average current (ATmega32 datasheet typical values at 16 MHz and 5 V,
+ * MCU only, without LEDs and segments): about 15 mA active and 6 mA idle.
+ * The CPU wakes 1600 times a second (display at 600 Hz, timebase at
+ * 1 kHz), but only the TIMEBASE_EVENT_HZ EVENT_TICKs and the rare button,
+ * split and capture events leave Power_Idle(). Estimated cycles per
+ * second: display ISR about 250 x 600 = 150k, timebase ISR about 100 x
+ * 1000 = 100k, sleep and wake-up about 20 x 1600 = 32k, main loop pass
+ * (scheduler, render and StopWatch_Expired with their 32-bit divisions)
+ * about 3000 x 100 = 300k. That is about 0.6M of 16M cycles, so the CPU
+ * is awake about 4% of the time and the MCU averages about 6.4 mA instead
+ * of 15 mA while spinning. Returning to the loop on every interrupt would
+ * run 1600 loop passes a second, about 5M cycles or a third of the time.
+ * The lit display dominates the rest of the budget.
+ *
+ * Power-fail detection: the analog comparator compares the raw supply,
+ * taken ahead of the regulator through a divider on POWER_FAIL_PIN, with
+ * the 1.23 V bandgap. When the divided supply drops below the bandgap the
+ * ANA_COMP interrupt blanks the display and the LEDs, silences the buzzer
+ * and calls Persist_Emergency(), which needs up to PERSIST_EMERGENCY_MS.
+ * The reservoir capacitor must keep the regulator in regulation that long:
+ * C >= I * t / dV, with I the current left after blanking (about 20 mA),
+ * t = PERSIST_EMERGENCY_MS and dV the margin between the trip voltage and
+ * the regulator dropout. A 9 V supply tripping at 8.0 V (56k over 10k)
+ * into a 7805 (6.5 V minimum input) needs 20 mA * 77 ms / 1.5 V, about
+ * 1000 uF. If the supply comes back instead, the MCU restarts through the
+ * watchdog and resumes from the record just written.
+ */
+
+#include "EventQueue.h"
+#include "GPIO.h"
+
+#ifndef POWER_H
+#define POWER_H
+
+/** @name Wake Profiling
+ *  PA6 is free (the digit select lines use PA0..PA5, the tick profile PA7)
+ *  unless it senses the supply (POWER_FAIL_DETECT).
+ */
+///@{
+#define WAKE_PROFILE_PORT 'A'
+#define WAKE_PROFILE_PIN PA6
+///@}
+
+/** @name Power-Fail Detection
+ *  AIN0 and AIN1 (PB2, PB3) carry buttons, so the comparator takes its
+ *  negative input from the ADC multiplexer; ADC6 shares PA6 with the wake
+ *  profile. Off by default: the stock board leaves PA6 open, and a
+ *  floating input would trip the emergency save at random. Set
+ *  POWER_FAIL_DETECT to 1 on a board with the supply divider on PA6 and
+ *  the reservoir capacitor described above.
+ */
+///@{
+#ifndef POWER_FAIL_DETECT
+#define POWER_FAIL_DETECT 0
+#endif
+
+#define POWER_FAIL_PORT 'A'
+#define POWER_FAIL_PIN PA6
+#define POWER_FAIL_MUX 6           /**< ADC multiplexer channel of POWER_FAIL_PIN */
+#define POWER_FAIL_RECOVER_MS 100  /**< Supply good this long after a trip before restarting */
+
+#if POWER_FAIL_DETECT && defined(WAKE_PROFILE)
+#error "WAKE_PROFILE_PIN is the power-fail sense input; set POWER_FAIL_DETECT to 0 to profile"
+#endif
+///@}
+
+/**
+ * @brief Turn off the ADC and arm the power-fail comparator (or turn it off).
+ *
+ * Requires Persist_Init(): the interrupt may fire as soon as this returns.
+ */
+void Power_Init();
+
+/**
+ * @brief Sleep in idle mode until an event is queued, unless one already is.
+ *
+ * The queue is checked with interrupts off and sei() is directly followed by
+ * the sleep instruction, so an event queued in between cannot be missed:
+ * the interrupt that queues it wakes the CPU. An interrupt that queues
+ * nothing (most display and timebase interrupts) goes back to sleep
+ * without returning to the main loop.
+ */
+void Power_Idle();
+
+/**
+ * @brief Mark the end of servicing an event (WAKE_PROFILE only).
+ */
+void Power_Serviced();
+
+#endif // POWER_H
@@ -5,6 +5,20 @@
  */
 
 #include "PushButton.h"
+#include <util/atomic.h>
+
+/** @name Debouncer State (one byte per port, one bit per pin) */
+///@{
+static uint8 DebounceCount0[NUM_PORTS];        /**< Vertical counter, bit 0 */
+static uint8 DebounceCount1[NUM_PORTS];        /**< Vertical counter, bit 1 */
+static volatile uint8 DebounceLevels[NUM_PORTS];  /**< Debounced pin levels */
+static volatile uint8 DebounceRising[NUM_PORTS];  /**< Accumulated LOW to HIGH edges */
+static volatile uint8 DebounceFalling[NUM_PORTS]; /**< Accumulated HIGH to LOW edges */
+static volatile uint8 DebounceTicks;              /**< Samples since the last snapshot */
+static uint8 DebounceMask[NUM_PORTS];             /**< Pins that are debounced */
+///@}
+
+static uint8 DebouncePort(uint8 index, uint8 sample);
 
 /**
  * @brief Initializes a push button.
@@ -22,6 +36,13 @@ void PushButton_Init(PushButton* button, uint8 port, uint8 pin, ButtonType type)
 	button->pin  = pin;
 	button->type = type;
 
+	// Precompute the snapshot lookup so SampleDebouncedButton() is a mask and an XOR
+	button->portIndex = port - 'A';
+	button->mask      = (1 << pin);
+	button->polarity  = (type == PULL_DOWN) ? 0 : button->mask;
+	button->state     = RELEASED;
+	button->edges     = 0;
+
 	SetPin(port, pin, INPUT); // Set as input
 
 	// Enable internal pull-up if needed
@@ -66,3 +87,182 @@ uint8 ReadButton(PushButton* button)
 	}
 	return ButtonReading;
 }
+
+/**
+ * @brief Seeds the debouncer with the current pin levels of the watched pins.
+ */
+void Debounce_Init(const PortSnapshot* watched)
+{
+	PortSnapshot inputs;
+	TakePortSnapshot(&inputs);
+
+	for (int i = 0; i < NUM_PORTS; i++)
+	{
+		DebounceMask[i]    = watched->pins[i];
+		DebounceCount0[i]  = 0xFF;
+		DebounceCount1[i]  = 0xFF;
+		DebounceLevels[i]  = inputs.pins[i];
+		DebounceRising[i]  = 0;
+		DebounceFalling[i] = 0;
+	}
+	DebounceTicks = 0;
+}
+
+/**
+ * @brief Samples every port once and advances its vertical counters.
+ *
+ * @return uint8 Bitmask of port indices that got a new debounced edge.
+ */
+uint8 Debounce_Update()
+{
+	uint8 edgePorts = 0;
+
+	if (DebouncePort(0, PINA)) edgePorts |= (1 << 0);
+	if (DebouncePort(1, PINB)) edgePorts |= (1 << 1);
+	if (DebouncePort(2, PINC)) edgePorts |= (1 << 2);
+	if (DebouncePort(3, PIND)) edgePorts |= (1 << 3);
+
+	if (DebounceTicks != 0xFF)
+	{
+		DebounceTicks++;
+	}
+
+	return edgePorts;
+}
+
+/**
+ * @brief Runs the 2-bit vertical counters of one port.
+ *
+ * A counter is held at 3 while its pin agrees with the debounced level and
+ * counts down while it differs; the level flips when the counter wraps.
+ *
+ * @param index Port index (0 = A).
+ * @param sample Raw PINx value.
+ * @return uint8 Non-zero if any pin of the port changed its debounced level.
+ */
+static uint8 DebouncePort(uint8 index, uint8 sample)
+{
+	uint8 level   = DebounceLevels[index];
+	uint8 changed = (level ^ sample) & DebounceMask[index]; // other pins never leave their seed level
+	uint8 count0  = ~(DebounceCount0[index] & changed);
+	uint8 count1  = count0 ^ (DebounceCount1[index] & changed);
+
+	DebounceCount0[index] = count0;
+	DebounceCount1[index] = count1;
+
+	changed &= count0 & count1; // pins whose counter wrapped
+	if (changed)
+	{
+		level ^= changed;
+		DebounceLevels[index] = level;
+		DebounceRising[index]  |= changed & level;
+		DebounceFalling[index] |= changed & ~level;
+	}
+
+	return changed;
+}
+
+/**
+ * @brief Copies the debounced levels and clears the accumulated edges.
+ *
+ * @param snapshot Pointer to the snapshot to fill.
+ */
+void TakeDebouncedSnapshot(DebouncedSnapshot* snapshot)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for (int i = 0; i < NUM_PORTS; i++)
+		{
+			snapshot->levels.pins[i]  = DebounceLevels[i];
+			snapshot->rising.pins[i]  = DebounceRising[i];
+			snapshot->falling.pins[i] = DebounceFalling[i];
+			DebounceRising[i]  = 0;
+			DebounceFalling[i] = 0;
+		}
+		snapshot->ticks = DebounceTicks;
+		DebounceTicks = 0;
+	}
+}
+
+/**
+ * @brief Resolves the button state and edges from a debounced snapshot.
+ *
+ * @param button Pointer to the initialized PushButton struct.
+ * @param snapshot Snapshot taken with TakeDebouncedSnapshot().
+ */
+void SampleDebouncedButton(PushButton* button, const DebouncedSnapshot* snapshot)
+{
+	uint8 index = button->portIndex;
+
+	// Active-low buttons are pressed on a falling edge, active-high on a rising one
+	uint8 pressEdges   = button->polarity ? snapshot->falling.pins[index] : snapshot->rising.pins[index];
+	uint8 releaseEdges = button->polarity ? snapshot->rising.pins[index]  : snapshot->falling.pins[index];
+
+	button->state = ((snapshot->levels.pins[index] ^ button->polarity) & button->mask) ? PRESSED : RELEASED;
+	button->edges = ((pressEdges & button->mask) ? BUTTON_PRESS_EDGE : 0) |
+	                ((releaseEdges & button->mask) ? BUTTON_RELEASE_EDGE : 0);
+}
+
+/**
+ * @brief Initializes the hold-to-repeat state of a button.
+ *
+ * @param repeat Pointer to the AutoRepeat struct to initialize.
+ * @param config Timing configuration shared by any number of buttons.
+ */
+void AutoRepeat_Init(AutoRepeat* repeat, const AutoRepeatConfig* config)
+{
+	repeat->config    = config;
+	repeat->countdown = config->initialDelay;
+	repeat->period    = config->repeatPeriod;
+	repeat->repeats   = 0;
+}
+
+/**
+ * @brief Counts the actions a button asks for since the previous call.
+ *
+ * @param repeat Pointer to the AutoRepeat struct of the button.
+ * @param button Pointer to the sampled PushButton struct.
+ * @param elapsedTicks Debounce ticks since the previous call.
+ * @return uint8 Number of actions to perform.
+ */
+uint8 AutoRepeat_Update(AutoRepeat* repeat, const PushButton* button, uint8 elapsedTicks)
+{
+	const AutoRepeatConfig* config = repeat->config;
+	uint8 steps = 0;
+
+	if (button->edges & BUTTON_PRESS_EDGE)
+	{
+		// The press itself acts immediately and restarts the timing
+		steps = 1;
+		repeat->countdown = config->initialDelay;
+		repeat->period    = config->repeatPeriod;
+		repeat->repeats   = 0;
+		elapsedTicks = 0;
+	}
+
+	if (button->state != PRESSED)
+	{
+		return steps;
+	}
+
+	while (elapsedTicks >= repeat->countdown)
+	{
+		elapsedTicks -= repeat->countdown;
+		steps++;
+
+		// Speed up after every accelSteps repeats
+		if (++repeat->repeats >= config->accelSteps && repeat->period > config->minPeriod)
+		{
+			repeat->repeats = 0;
+			repeat->period >>= 1;
+			if (repeat->period < config->minPeriod)
+			{
+				repeat->period = config->minPeriod;
+			}
+		}
+		repeat->countdown = repeat->period;
+	}
+	repeat->countdown -= elapsedTicks;
+
+	return steps;
+}
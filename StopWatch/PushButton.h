@@ -20,6 +20,28 @@
 /** @brief Value returned when button is released. */
 #define RELEASED 0
 
+/** @name Button Edge Flags
+ *  Reported in PushButton::edges by SampleDebouncedButton().
+ */
+///@{
+#define BUTTON_PRESS_EDGE   0x01 /**< Button went from RELEASED to PRESSED */
+#define BUTTON_RELEASE_EDGE 0x02 /**< Button went from PRESSED to RELEASED */
+///@}
+
+/**
+ * @brief Debounced input levels and the edges seen since the last read.
+ *
+ * Edges refer to pin levels, SampleDebouncedButton() maps them to press and
+ * release using the polarity of each button.
+ */
+typedef struct
+{
+	PortSnapshot levels;  /**< Debounced level of every pin */
+	PortSnapshot rising;  /**< Pins that went LOW to HIGH since the last snapshot */
+	PortSnapshot falling; /**< Pins that went HIGH to LOW since the last snapshot */
+	uint8 ticks;          /**< Debounce samples taken since the last snapshot (saturates at 255) */
+} DebouncedSnapshot;
+
 /**
  * @brief Enumeration for the electrical type of push button.
  */
@@ -38,8 +60,22 @@ typedef struct
 	uint8 port;       /**< Port number (0 = A, 1 = B, etc.) */
 	uint8 pin;        /**< Pin number (0 to 7) */
 	ButtonType type;  /**< Electrical type of button */
+	uint8 portIndex;  /**< Index of the port in a PortSnapshot */
+	uint8 mask;       /**< Bit of the pin within its port */
+	uint8 polarity;   /**< mask if the pin reads LOW when pressed, 0 otherwise */
+	uint8 state;      /**< State from the last SampleDebouncedButton() (PRESSED or RELEASED) */
+	uint8 edges;      /**< BUTTON_*_EDGE flags from the last SampleDebouncedButton() */
 } PushButton;
 
+/**
+ * @brief Compile-time equivalent of ReadButton().
+ *
+ * For buttons whose port, pin and type are compile-time constants; compiles
+ * down to a single sbic/sbis when used as a condition.
+ */
+#define READ_BUTTON(port, pin, type) \
+	(FAST_READ_PIN(port, pin) == ((type) == PULL_DOWN ? HIGH : LOW) ? PRESSED : RELEASED)
+
 /**
  * @brief Initialize a push button by setting pin direction and pull configuration.
  *
@@ -58,4 +94,92 @@ void PushButton_Init(PushButton* button, uint8 port, uint8 pin, ButtonType type)
  */
 uint8 ReadButton(PushButton* button);
 
+/**
+ * @brief Seed the debouncer with the current pin levels.
+ *
+ * Call once after the buttons are initialized, before the periodic tick
+ * starts calling Debounce_Update(). Only the pins in @p watched are
+ * debounced; the others (outputs, unused inputs) never report an edge.
+ *
+ * @param watched Mask of the button pins of each port.
+ */
+void Debounce_Init(const PortSnapshot* watched);
+
+/**
+ * @brief Advance the debouncer by one sample of every port.
+ *
+ * Meant to be called from a periodic ISR every 1–2 ms. All pins of a port are
+ * debounced in parallel with 2-bit vertical counters, so a level is accepted
+ * after 4 consecutive equal samples and the cost does not depend on the
+ * number of buttons.
+ *
+ * @return uint8 Bitmask of port indices (bit 0 = A) that got a new debounced edge.
+ */
+uint8 Debounce_Update();
+
+/**
+ * @brief Copy the debounced levels and consume the accumulated edges.
+ *
+ * @param snapshot Pointer to the snapshot to fill.
+ */
+void TakeDebouncedSnapshot(DebouncedSnapshot* snapshot);
+
+/**
+ * @brief Resolve a button from a debounced snapshot.
+ *
+ * Updates button->state and sets button->edges to the BUTTON_*_EDGE flags
+ * seen since the previous snapshot (0 if none). The edges come from the
+ * debouncer, so a press and release that both happen between two
+ * snapshots are still reported.
+ *
+ * @param button Pointer to the PushButton struct.
+ * @param snapshot Snapshot taken with TakeDebouncedSnapshot().
+ */
+void SampleDebouncedButton(PushButton* button, const DebouncedSnapshot* snapshot);
+
+/**
+ * @brief Hold-to-repeat timing, in debounce ticks.
+ *
+ * The first repeat fires after initialDelay, then every repeatPeriod. After
+ * every accelSteps repeats the period is halved, down to minPeriod.
+ */
+typedef struct
+{
+	uint16 initialDelay; /**< Hold time before the first repeat */
+	uint16 repeatPeriod; /**< Period of the first repeats */
+	uint16 minPeriod;    /**< Fastest repeat period (at least 1) */
+	uint8 accelSteps;    /**< Repeats at each period before it is halved */
+} AutoRepeatConfig;
+
+/**
+ * @brief Hold-to-repeat state of one button.
+ */
+typedef struct
+{
+	const AutoRepeatConfig* config; /**< Shared timing configuration */
+	uint16 countdown;               /**< Ticks left until the next repeat */
+	uint16 period;                  /**< Current repeat period */
+	uint8 repeats;                  /**< Repeats done at the current period */
+} AutoRepeat;
+
+/**
+ * @brief Initialize the hold-to-repeat state of a button.
+ *
+ * @param repeat Pointer to the AutoRepeat struct to initialize.
+ * @param config Timing configuration, must outlive the AutoRepeat.
+ */
+void AutoRepeat_Init(AutoRepeat* repeat, const AutoRepeatConfig* config);
+
+/**
+ * @brief Advance a hold-to-repeat state machine without blocking.
+ *
+ * Call once per debounced snapshot, after SampleDebouncedButton().
+ *
+ * @param repeat Pointer to the AutoRepeat struct of the button.
+ * @param button Pointer to the sampled PushButton struct.
+ * @param elapsedTicks Ticks since the previous call (DebouncedSnapshot::ticks).
+ * @return uint8 Number of actions to perform: 1 on the press itself, plus one per repeat.
+ */
+uint8 AutoRepeat_Update(AutoRepeat* repeat, const PushButton* button, uint8 elapsedTicks);
+
 #endif // PUSH_BUTTON_H
@@ -0,0 +1,151 @@
+/**
+ * @file Scheduler.c
+ * @brief Hashed timer wheel driven from the main loop.
+ */
+
+#include "Scheduler.h"
+
+#define SCHEDULER_MASK (SCHEDULER_SLOTS - 1)
+
+/// Timer lists, indexed by due tick modulo SCHEDULER_SLOTS
+static SoftTimer* Wheel[SCHEDULER_SLOTS];
+
+/// Last tick processed by Scheduler_Run()
+static Ticks Cursor;
+
+/// Next timer of the slot being processed, kept valid across cancels in callbacks
+static SoftTimer* Pending;
+
+/**
+ * @brief Links a timer into the slot of its due tick.
+ *
+ * New timers go to the head of the list, so a periodic timer re-armed
+ * into the slot being processed is not visited again in the same pass.
+ */
+static void Insert(SoftTimer* timer)
+{
+	Ticks offset = timer->due - Cursor;
+
+	// Overdue (a late periodic reload): run on the next tick
+	if (offset == 0 || (int32)offset < 0)
+	{
+		timer->due = Cursor + 1;
+		offset = 1;
+	}
+	timer->turns = (offset - 1) / SCHEDULER_SLOTS;
+
+	SoftTimer** head = &Wheel[timer->due & SCHEDULER_MASK];
+	timer->next = *head;
+	if (*head)
+	{
+		(*head)->link = &timer->next;
+	}
+	*head = timer;
+	timer->link = head;
+}
+
+/**
+ * @brief Starts the wheel at the current tick with no timers.
+ */
+void Scheduler_Init()
+{
+	for (uint8 i = 0; i < SCHEDULER_SLOTS; i++)
+	{
+		Wheel[i] = NULL;
+	}
+	Cursor = TimeBase_Now();
+	Pending = NULL;
+}
+
+/**
+ * @brief Processes every tick since the last call, one slot each.
+ */
+void Scheduler_Run()
+{
+	Ticks now = TimeBase_Now();
+
+	while (Cursor != now)
+	{
+		Cursor++;
+
+		SoftTimer* timer = Wheel[Cursor & SCHEDULER_MASK];
+		while (timer)
+		{
+			Pending = timer->next;
+
+			if (timer->turns)
+			{
+				timer->turns--;
+			}
+			else
+			{
+				SoftTimer_Cancel(timer);
+				if (timer->period)
+				{
+					timer->due += timer->period;
+					Insert(timer);
+				}
+				timer->callback(timer->context);
+			}
+
+			timer = Pending;
+		}
+	}
+	Pending = NULL;
+}
+
+/**
+ * @brief Prepares a stopped timer.
+ */
+void SoftTimer_Init(SoftTimer* timer, TimerCallback callback, void* context)
+{
+	timer->next = NULL;
+	timer->link = NULL;
+	timer->callback = callback;
+	timer->context = context;
+	timer->period = 0;
+}
+
+/**
+ * @brief Schedules a timer @p delay ticks from now.
+ */
+void SoftTimer_Start(SoftTimer* timer, Ticks delay, Ticks period)
+{
+	SoftTimer_Cancel(timer);
+
+	timer->due = TimeBase_Now() + (delay ? delay : 1);
+	timer->period = period;
+	Insert(timer);
+}
+
+/**
+ * @brief Unlinks a timer in O(1).
+ */
+void SoftTimer_Cancel(SoftTimer* timer)
+{
+	if (!timer->link)
+	{
+		return;
+	}
+
+	if (timer == Pending)
+	{
+		Pending = timer->next;
+	}
+
+	*timer->link = timer->next;
+	if (timer->next)
+	{
+		timer->next->link = timer->link;
+	}
+	timer->next = NULL;
+	timer->link = NULL;
+}
+
+/**
+ * @brief Reports whether a timer is linked into the wheel.
+ */
+uint8 SoftTimer_Active(const SoftTimer* timer)
+{
+	return timer->link != NULL;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file Scheduler.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Software timers on the shared timebase tick.
+ *
+ * A hashed timer wheel of SCHEDULER_SLOTS lists, one per timebase tick.
+ * A timer sits in the slot of its due tick with the number of whole wheel
+ * turns still to wait, so starting and cancelling are O(1) list operations
+ * and each tick only visits the timers hashed to its slot.
+ *
+ * Timers are owned (statically allocated) by the modules that use them;
+ * the scheduler only links them. Callbacks run from Scheduler_Run() in the
+ * main loop, never in interrupt context, so they may use any API. Work
+ * that must not jitter, such as display multiplexing and button sampling,
+ * stays in the Timer0 ISR.
+ */
+
+#include "TimeBase.h"
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/** @brief Wheel size in ticks (power of two). */
+#define SCHEDULER_SLOTS 64
+
+#if (SCHEDULER_SLOTS & (SCHEDULER_SLOTS - 1))
+#error "SCHEDULER_SLOTS must be a power of two"
+#endif
+
+/** @brief Timebase ticks for a delay in milliseconds, rounded up. */
+#define MS_TO_TICKS(ms) ((Ticks)(((ms) * TIMEBASE_HZ + 999UL) / 1000UL))
+
+/**
+ * @brief Timer callback.
+ * @param context Pointer given to SoftTimer_Init().
+ */
+typedef void (*TimerCallback)(void* context);
+
+/**
+ * @brief A software timer. Initialize with SoftTimer_Init() before use.
+ */
+typedef struct SoftTimer
+{
+	struct SoftTimer* next;   /**< Next timer in the slot */
+	struct SoftTimer** link;  /**< Pointer that points to this timer, NULL when stopped */
+	TimerCallback callback;   /**< Called when the timer expires */
+	void* context;            /**< Passed to the callback */
+	Ticks due;                /**< Tick of the next expiry */
+	Ticks period;             /**< Reload in ticks, 0 for a one-shot */
+	Ticks turns;              /**< Whole wheel turns left before due */
+} SoftTimer;
+
+/**
+ * @brief Start the wheel at the current tick. Requires TimeBase_Init().
+ */
+void Scheduler_Init();
+
+/**
+ * @brief Run the callbacks of all timers that expired since the last call.
+ *
+ * Call it from the main loop after every wake-up; the timebase EVENT_TICK
+ * guarantees one at least every 1/TIMEBASE_EVENT_HZ seconds, which bounds
+ * the callback latency.
+ */
+void Scheduler_Run();
+
+/**
+ * @brief Prepare a timer.
+ *
+ * @param timer Timer to prepare (stopped).
+ * @param callback Function to call on expiry.
+ * @param context Pointer passed to the callback.
+ */
+void SoftTimer_Init(SoftTimer* timer, TimerCallback callback, void* context);
+
+/**
+ * @brief Start or restart a timer.
+ *
+ * @param timer Timer to start; a running timer is rescheduled.
+ * @param delay Ticks until the first expiry (at least 1; see MS_TO_TICKS()).
+ * @param period Ticks between later expiries, 0 for a one-shot.
+ */
+void SoftTimer_Start(SoftTimer* timer, Ticks delay, Ticks period);
+
+/**
+ * @brief Stop a timer. Stopping a stopped timer does nothing.
+ *
+ * Safe from inside any callback, including the timer's own.
+ *
+ * @param timer Timer to stop.
+ */
+void SoftTimer_Cancel(SoftTimer* timer);
+
+/**
+ * @brief Check whether a timer is running.
+ *
+ * @param timer Timer to check.
+ * @return uint8 TRUE if the timer is scheduled.
+ */
+uint8 SoftTimer_Active(const SoftTimer* timer);
+
+#endif // SCHEDULER_H
@@ -20,7 +20,7 @@ void SevenSegment_Init(SevenSegment* mySeg, uint8 dataPort, uint8 dataPins)
 	mySeg->dataMusk = dataPins;
 
 	// Extract and store pin numbers from bitmask
-	for (int i = 0, j = 0; i < REGISTER_SIZE; i++)
+	for (int i = 0, j = 0; i < REGISTER_SIZE && j < NUM_DATA_PINS; i++)
 	{
 		if (dataPins & (1 << i))
 		{
@@ -28,6 +28,16 @@ void SevenSegment_Init(SevenSegment* mySeg, uint8 dataPort, uint8 dataPins)
 		}
 	}
 
+	// Contiguous pins only need a shift, scattered pins are spread bit by bit
+	if ((dataPins >> mySeg->dataPins[0]) == (NUM_DATA_CODES - 1))
+	{
+		mySeg->dataShift = mySeg->dataPins[0];
+	}
+	else
+	{
+		mySeg->dataShift = DATA_PINS_SCATTERED;
+	}
+
 	// Set each of the data pins as output
 	for (int i = 0; i < NUM_DATA_PINS; i++)
 	{
@@ -41,14 +51,12 @@ void SevenSegment_Init(SevenSegment* mySeg, uint8 dataPort, uint8 dataPins)
  * @brief Displays a 4-bit binary number (0–15) on a 7-segment display.
  *
  * This function assumes a BCD-to-7-segment decoder is connected to the pins.
+ * All data pins are updated together in one port write.
  *
  * @param mySeg Pointer to the initialized SevenSegment struct.
  * @param data 4-bit number to display (usually 0–9 for digits).
  */
 void WriteSevenSegment(SevenSegment* mySeg, uint8 data)
 {
-	for (int i = 0; i < NUM_DATA_PINS; i++)
-	{
-		WritePin(mySeg->dataPort, mySeg->dataPins[i], (data & (1 << i)) ? HIGH : LOW);
-	}
+	WritePortMasked(mySeg->dataPort, mySeg->dataMusk, SEVEN_SEGMENT_BITS(mySeg, data));
 }
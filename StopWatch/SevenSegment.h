@@ -16,6 +16,12 @@
 /** @brief Number of data pins used (for 4-bit BCD). */
 #define NUM_DATA_PINS 4
 
+/** @brief Number of 4-bit codes a seven-segment data bus can carry. */
+#define NUM_DATA_CODES (1 << NUM_DATA_PINS)
+
+/** @brief dataShift value marking data pins that are not contiguous. */
+#define DATA_PINS_SCATTERED 0xFF
+
 /**
  * @brief Structure representing a seven-segment display module.
  */
@@ -24,8 +30,60 @@ typedef struct
 	uint8 dataPort;                   /**< Pointer to the data PORT register */
 	uint8 dataPins[NUM_DATA_PINS];     /**< Array of pin numbers used for data (4-bit BCD) */
 	uint8 dataMusk;                    /**< Bitmask representing active data pins */
+	uint8 dataShift;                   /**< Lowest data pin for contiguous pins, DATA_PINS_SCATTERED otherwise */
 } SevenSegment;
 
+/**
+ * @brief Spreads a 4-bit code over scattered data pins.
+ *
+ * Computed per write rather than from a per-display lookup table, so the
+ * digits of a multiplexed display do not each carry 16 bytes of RAM.
+ * Inlined so that ISRs using it make no call.
+ *
+ * @param mySeg Pointer to an initialized SevenSegment struct.
+ * @param data BCD digit (0–9) to display.
+ * @return uint8 Port bits within dataMusk.
+ */
+static ALWAYS_INLINE uint8 SevenSegment_Scatter(const SevenSegment* mySeg, uint8 data)
+{
+	uint8 bits = 0;
+	for (uint8 i = 0; i < NUM_DATA_PINS; i++)
+	{
+		if (data & (1 << i))
+		{
+			bits |= (1 << mySeg->dataPins[i]);
+		}
+	}
+	return bits;
+}
+
+/**
+ * @brief Port bits (within dataMusk) that display a 4-bit code.
+ *
+ * Contiguous pins, the usual wiring, only need a shift.
+ *
+ * @param mySeg Pointer to an initialized SevenSegment struct.
+ * @param data BCD digit (0–9) to display.
+ */
+#define SEVEN_SEGMENT_BITS(mySeg, data)        \
+	((mySeg)->dataShift == DATA_PINS_SCATTERED \
+		? SevenSegment_Scatter(mySeg, data)    \
+		: (uint8)((data) << (mySeg)->dataShift))
+
+/**
+ * @brief WriteSevenSegment() variant for a data port known at compile time.
+ *
+ * Updates all data pins with one store to the resolved PORTx register, so the
+ * decoder never sees an intermediate code. Not interrupt-protected: meant for
+ * ISRs or callers that own the port.
+ *
+ * @param port Compile-time port character of the data pins.
+ * @param mySeg Pointer to an initialized SevenSegment struct on that port.
+ * @param data BCD digit (0–9) to display.
+ */
+#define WRITE_SEVEN_SEGMENT_FAST(port, mySeg, data) \
+	FAST_WRITE_PORT_MASKED(port, (mySeg)->dataMusk, SEVEN_SEGMENT_BITS(mySeg, data))
+
 /**
  * @brief Initialize a seven-segment display structure.
  *
@@ -0,0 +1,269 @@
+/**
+ * @file TimeBase.c
+ * @brief Free-running tick counter shared by every time consumer.
+ */
+
+#include "TimeBase.h"
+#include <util/atomic.h>
+
+/// Ticks since TimeBase_Init(), written only by the tick ISR
+volatile Ticks g_TimeBaseTicks;
+
+/// Trim phase accumulator increment per slot; 0 disables the trim
+static volatile uint16 TrimStep;
+
+/// TOP used for a slot in which the accumulator carried
+static volatile uint16 TrimTop = TIMEBASE_COMPARE_MATCH;
+
+/// Applied trim in 0.01 ppm
+static int16 TrimCentiPpm;
+
+/// Captured edges, filled by the capture ISR and drained by the main loop
+static volatile TimeStamp Captures[TIMEBASE_CAPTURE_SIZE];
+static volatile uint8 CaptureHead;
+static volatile uint8 CaptureTail;
+
+/**
+ * @brief Timebase Compare Match ISR (Timer1 A or Timer2).
+ * Counts the tick; every TIMEBASE_EVENT_DIVIDER-th tick it also applies the
+ * crystal trim and reports to the main loop.
+ */
+ISR(TIMEBASE_vect)
+{
+	static uint8 eventDivider = 0;
+	static uint16 trimPhase = 0;
+
+#ifdef TICK_PROFILE
+	FAST_WRITE_PIN(TICK_PROFILE_PORT, TICK_PROFILE_PIN, HIGH);
+#endif
+
+	g_TimeBaseTicks++;
+
+	if (++eventDivider == TIMEBASE_EVENT_DIVIDER)
+	{
+		eventDivider = 0;
+
+		// Crystal trim, once per slot: the counter has just restarted, so the new TOP is safe to load
+		uint16 phase = trimPhase + TrimStep;
+#if TIMEBASE_SOURCE == TIMEBASE_TIMER2_ASYNC
+		// OCR2 still busy with the previous write: keep the phase and retry next slot
+		if (!IS_SET(ASSR, OCR2UB))
+#endif
+		{
+			TIMEBASE_TOP_REG = (phase < trimPhase) ? TrimTop : TIMEBASE_COMPARE_MATCH;
+			trimPhase = phase;
+		}
+
+		EventQueue_Push(EVENT_TICK, 0);
+	}
+
+#ifdef TICK_PROFILE
+	FAST_WRITE_PIN(TICK_PROFILE_PORT, TICK_PROFILE_PIN, LOW);
+#endif
+}
+
+/**
+ * @brief Completes a counter value with the tick it belongs to.
+ *
+ * Must run with interrupts off (or from an ISR). A tick that ended just
+ * before the count was latched may not be counted yet: then the compare
+ * match flag is still pending and the count is near the bottom.
+ *
+ * @param counts Counter or ICR1 value.
+ * @return Ticks Tick the count belongs to.
+ */
+static ALWAYS_INLINE Ticks TickOfCount(uint16 counts)
+{
+	Ticks ticks = g_TimeBaseTicks;
+
+	if (IS_SET(TIFR, TIMEBASE_MATCH_FLAG) && counts < (TIMEBASE_COUNTS / 2))
+	{
+		ticks++;
+	}
+	return ticks;
+}
+
+#if TIMEBASE_HAS_CAPTURE
+/**
+ * @brief Timer1 Input Capture ISR.
+ * Extends ICR1 with the tick count and buffers the timestamp.
+ *
+ * The capture ISR has priority over the compare match ISR, so the tick
+ * count may lag ICR1 by one; TickOfCount() corrects it.
+ */
+ISR(TIMER1_CAPT_vect)
+{
+	uint16 counts = ICR1;
+	Ticks ticks = TickOfCount(counts);
+
+	uint8 head = CaptureHead;
+	if ((uint8)(head - CaptureTail) == TIMEBASE_CAPTURE_SIZE)
+	{
+		return; // main loop is behind, drop the edge
+	}
+	Captures[head & (TIMEBASE_CAPTURE_SIZE - 1)].ticks = ticks;
+	Captures[head & (TIMEBASE_CAPTURE_SIZE - 1)].counts = counts;
+	CaptureHead = head + 1;
+
+	EventQueue_Push(EVENT_CAPTURE, 0);
+}
+#endif
+
+/**
+ * @brief Starts the timebase counter in CTC mode at TIMEBASE_HZ.
+ */
+void TimeBase_Init()
+{
+	g_TimeBaseTicks = 0;
+
+#ifdef TICK_PROFILE
+	FAST_SET_PIN(TICK_PROFILE_PORT, TICK_PROFILE_PIN, OUTPUT);
+#endif
+
+#if TIMEBASE_SOURCE == TIMEBASE_TIMER1
+	Timer1_CTC_Init(TIMEBASE_COMPARE_MATCH, TIMEBASE_PRESCALAR);
+	Timer1_Restart();
+#else
+	Timer2_Async_CTC_Init(TIMEBASE_COMPARE_MATCH, TIMEBASE_PRESCALAR);
+#endif
+}
+
+/**
+ * @brief Reads the tick counter, retrying if a tick landed mid-read.
+ *
+ * @return Ticks Current tick count.
+ */
+Ticks TimeBase_Now()
+{
+	Ticks now;
+
+	do
+	{
+		now = g_TimeBaseTicks;
+	} while (now != g_TimeBaseTicks);
+
+	return now;
+}
+
+/**
+ * @brief Reads the counter and the tick count as one timestamp.
+ *
+ * @param stamp Pointer to the timestamp to fill.
+ */
+void TimeBase_Stamp(TimeStamp* stamp)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		uint16 counts = TIMEBASE_COUNT_REG;
+		stamp->ticks = TickOfCount(counts);
+		stamp->counts = counts;
+	}
+}
+
+#if TIMEBASE_HAS_CAPTURE
+/**
+ * @brief Enables hardware timestamping of ICP1 edges.
+ *
+ * @param edge Edge that triggers the capture.
+ */
+void TimeBase_Capture_Init(CaptureEdge edge)
+{
+	CaptureHead = 0;
+	CaptureTail = 0;
+
+	Timer1_Capture_Init(edge);
+}
+#endif
+
+/**
+ * @brief Takes the oldest buffered capture.
+ *
+ * @param stamp Pointer to the timestamp to fill.
+ * @return uint8 TRUE if a capture was taken, FALSE if none is buffered.
+ */
+uint8 TimeBase_PopCapture(TimeStamp* stamp)
+{
+	uint8 tail = CaptureTail;
+
+	if (tail == CaptureHead)
+	{
+		return FALSE;
+	}
+
+	stamp->ticks = Captures[tail & (TIMEBASE_CAPTURE_SIZE - 1)].ticks;
+	stamp->counts = Captures[tail & (TIMEBASE_CAPTURE_SIZE - 1)].counts;
+	CaptureTail = tail + 1; // release the slot only after it is read
+
+	return TRUE;
+}
+
+/**
+ * @brief Computes the timer clocks between two timestamps.
+ *
+ * @param from Earlier timestamp.
+ * @param to Later timestamp.
+ * @return uint32 Cycles between the edges, saturated at 0xFFFFFFFF.
+ */
+uint32 TimeBase_CyclesBetween(const TimeStamp* from, const TimeStamp* to)
+{
+	Ticks ticks = to->ticks - from->ticks;
+
+	if (ticks >= 0xFFFFFFFFUL / TIMEBASE_COUNTS)
+	{
+		return 0xFFFFFFFFUL;
+	}
+
+	// to->counts may be below from->counts; the sum is still positive
+	return ticks * TIMEBASE_COUNTS + to->counts - from->counts;
+}
+
+/**
+ * @brief Converts a crystal error into the trim accumulator step.
+ *
+ * A carry moves TIMEBASE_EVENT_DIVIDER counts, and there are
+ * TIMEBASE_EVENT_HZ slots per second, so the step is
+ * |error| * counter clock * 65536 / (TIMEBASE_EVENT_DIVIDER * TIMEBASE_EVENT_HZ).
+ *
+ * @param centiPpm Crystal error in 0.01 ppm, positive when the crystal runs fast.
+ */
+void TimeBase_SetTrim(int16 centiPpm)
+{
+	if (centiPpm > TIMEBASE_TRIM_LIMIT)
+	{
+		centiPpm = TIMEBASE_TRIM_LIMIT;
+	}
+	else if (centiPpm < -TIMEBASE_TRIM_LIMIT)
+	{
+		centiPpm = -TIMEBASE_TRIM_LIMIT;
+	}
+	TrimCentiPpm = centiPpm;
+
+	uint16 magnitude = (centiPpm < 0) ? -centiPpm : centiPpm;
+	uint16 step = (uint16)(((uint64)magnitude * (TIMEBASE_CLOCK / TIMEBASE_DIVISION) * 65536) / (100000000ULL * TIMEBASE_HZ));
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		TrimStep = step;
+		TrimTop = (centiPpm < 0) ? TIMEBASE_COMPARE_MATCH - 1 : TIMEBASE_COMPARE_MATCH + 1;
+	}
+}
+
+/**
+ * @brief Returns the applied trim.
+ *
+ * @return int16 Crystal error in 0.01 ppm.
+ */
+int16 TimeBase_Trim()
+{
+	return TrimCentiPpm;
+}
+
+/**
+ * @brief Converts ticks to hundredths, whole seconds first so ticks * 100 cannot overflow.
+ */
+uint32 TimeBase_Hundredths(Ticks ticks)
+{
+	Ticks seconds = ticks / TIMEBASE_HZ;
+
+	return seconds * 100 + ((ticks - seconds * TIMEBASE_HZ) * 100) / TIMEBASE_HZ;
+}
@@ -0,0 +1,246 @@
+/**
+ * @file TimeBase.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Free-running system timebase on Timer1 or on an asynchronous Timer2.
+ *
+ * The compare match ISR only increments a 32-bit tick counter. Every
+ * consumer keeps its own timestamps and derives what it needs from
+ * TimeBase_Now() or TimeBase_Stamp(), so any number of consumers cost no
+ * extra ISR work.
+ *
+ * TIMEBASE_SOURCE selects the counter:
+ * - TIMEBASE_TIMER1: 1 kHz ticks from the CPU crystal, timestamps at CPU
+ *   clock resolution and input capture (photogate, calibration).
+ * - TIMEBASE_TIMER2_ASYNC: 64 Hz ticks from a 32.768 kHz watch crystal on
+ *   TOSC1/TOSC2 (PC6/PC7), timestamps at 244 us. Timer2 keeps counting in
+ *   power-save sleep; there is no input capture.
+ */
+
+#include "Timers.h"
+#include "GPIO.h"
+#include "EventQueue.h"
+
+#ifndef TIME_BASE_H
+#define TIME_BASE_H
+
+/** @name Timebase Sources */
+///@{
+#define TIMEBASE_TIMER1       1
+#define TIMEBASE_TIMER2_ASYNC 2
+
+#ifndef TIMEBASE_SOURCE
+#define TIMEBASE_SOURCE TIMEBASE_TIMER1
+#endif
+///@}
+
+/** @name Timebase Configuration
+ *  Timer1: 1 kHz from the undivided CPU clock, TOP = 15999 is exact at
+ *  F_CPU = 16 MHz and the tick ISR costs well under 1% of the 16000 cycles
+ *  between ticks. Timer2: 64 Hz from 32768 / 8, TOP = 63.
+ */
+///@{
+#if TIMEBASE_SOURCE == TIMEBASE_TIMER1
+
+#define TIMEBASE_CLOCK F_CPU                           /**< Counter source clock, Hz */
+#define TIMEBASE_HZ 1000UL                             /**< Ticks per second */
+#define TIMEBASE_PRESCALAR NO_PRESCALAR                /**< Counter clock source */
+#define TIMEBASE_DIVISION 1UL                          /**< Division factor matching TIMEBASE_PRESCALAR */
+#define TIMEBASE_MAX_COUNTS 65536UL                    /**< Counter range */
+#define TIMEBASE_EVENT_HZ 100                          /**< EVENT_TICK rate; nothing to do between hundredths */
+#define TIMEBASE_HAS_CAPTURE 1                         /**< ICP1 timestamps available */
+
+#define TIMEBASE_vect TIMER1_COMPA_vect
+#define TIMEBASE_COUNT_REG TCNT1
+#define TIMEBASE_TOP_REG OCR1A
+#define TIMEBASE_MATCH_FLAG OCF1A
+
+#elif TIMEBASE_SOURCE == TIMEBASE_TIMER2_ASYNC
+
+#define TIMEBASE_CLOCK 32768UL
+#define TIMEBASE_HZ 64UL
+#define TIMEBASE_PRESCALAR PRESCALAR_8
+#define TIMEBASE_DIVISION 8UL
+#define TIMEBASE_MAX_COUNTS 256UL
+#define TIMEBASE_EVENT_HZ 64
+#define TIMEBASE_HAS_CAPTURE 0
+
+#define TIMEBASE_vect TIMER2_COMP_vect
+#define TIMEBASE_COUNT_REG TCNT2
+#define TIMEBASE_TOP_REG OCR2
+#define TIMEBASE_MATCH_FLAG OCF2
+
+#else
+#error "Unknown TIMEBASE_SOURCE"
+#endif
+
+#define TIMEBASE_COUNTS (TIMEBASE_CLOCK / TIMEBASE_DIVISION / TIMEBASE_HZ)   /**< Counts per tick */
+#define TIMEBASE_COMPARE_MATCH ((uint16)(TIMEBASE_COUNTS - 1))              /**< TOP */
+#define TIMEBASE_EVENT_DIVIDER ((uint8)(TIMEBASE_HZ / TIMEBASE_EVENT_HZ))
+
+#if (TIMEBASE_CLOCK % (TIMEBASE_DIVISION * TIMEBASE_HZ)) != 0
+#error "TIMEBASE_HZ is not an exact division of TIMEBASE_CLOCK with TIMEBASE_PRESCALAR"
+#endif
+
+// One spare count above TOP for the crystal trim
+#if (TIMEBASE_COUNTS < 3) || (TIMEBASE_COUNTS > TIMEBASE_MAX_COUNTS - 1)
+#error "TIMEBASE_HZ cannot be reached with TIMEBASE_PRESCALAR"
+#endif
+
+#if (TIMEBASE_HZ % TIMEBASE_EVENT_HZ) != 0 || (TIMEBASE_HZ / TIMEBASE_EVENT_HZ) > 255
+#error "TIMEBASE_EVENT_HZ must divide TIMEBASE_HZ"
+#endif
+///@}
+
+/** @name Crystal Trim
+ *  The trim is applied once per EVENT_TICK slot (TIMEBASE_EVENT_DIVIDER
+ *  ticks) by a 16-bit phase accumulator: when it carries, the whole slot
+ *  runs with TOP one count longer (crystal fast) or shorter (crystal slow).
+ *  The slot length sets the range, TIMEBASE_TRIM_LIMIT, and the accumulator
+ *  the resolution: about 0.001 ppm on Timer1, 0.25 ppm on Timer2.
+ */
+///@{
+#define TIMEBASE_TRIM_LIMIT 6000   /**< Largest trim magnitude, in 0.01 ppm */
+
+#if (TIMEBASE_TRIM_LIMIT * (TIMEBASE_CLOCK / TIMEBASE_DIVISION)) >= (100000000UL * TIMEBASE_HZ)
+#error "TIMEBASE_TRIM_LIMIT needs more than one trim count per slot"
+#endif
+///@}
+
+/** @name Tick ISR Profiling
+ *  Define TICK_PROFILE to drive TICK_PROFILE_PIN high for the duration of the
+ *  tick ISR body, so its length can be measured on a scope or logic
+ *  analyzer. PA7 is free (the digit select lines use PA0..PA5) and, unlike
+ *  PC6/PC7, is not taken by the watch crystal.
+ */
+///@{
+#define TICK_PROFILE_PORT 'A'
+#define TICK_PROFILE_PIN PA7
+///@}
+
+/**
+ * @brief Timestamp difference, in ticks.
+ *
+ * Differences are taken with unsigned wrap-around arithmetic, so they stay
+ * correct across counter overflow as long as they are below 2^31 ticks.
+ */
+typedef uint32 Ticks;
+
+/**
+ * @brief Timestamp at timer clock resolution.
+ *
+ * The instant is @p counts timer clocks after the start of tick @p ticks,
+ * so on Timer1 the resolution is one CPU cycle. The same layout holds a
+ * duration of whole ticks plus a fraction of a tick.
+ */
+typedef struct
+{
+	Ticks ticks;  /**< Timebase tick the edge fell in */
+	uint16 counts; /**< Counter or ICR1 value, 0 to TIMEBASE_COMPARE_MATCH (+1 in a trimmed tick) */
+} TimeStamp;
+
+/** @brief Number of captures buffered for the main loop (power of two). */
+#define TIMEBASE_CAPTURE_SIZE 4
+
+#if (TIMEBASE_CAPTURE_SIZE & (TIMEBASE_CAPTURE_SIZE - 1))
+#error "TIMEBASE_CAPTURE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Start the timebase (CTC mode, TIMEBASE_HZ interrupts per second).
+ *
+ * EVENT_TICK is queued TIMEBASE_EVENT_HZ times per second.
+ */
+void TimeBase_Init();
+
+/**
+ * @brief Read the current tick count.
+ *
+ * Consistent without disabling interrupts: the 4-byte read is repeated if
+ * the tick ISR ran in the middle of it.
+ *
+ * @return Ticks Ticks since TimeBase_Init().
+ */
+Ticks TimeBase_Now();
+
+/** @brief Tick count, defined in TimeBase.c and only exposed for TimeBase_NowFromISR(). */
+extern volatile Ticks g_TimeBaseTicks;
+
+/**
+ * @brief Read the current tick count from another ISR.
+ *
+ * Interrupts are off in an ISR, so the count cannot change during the read
+ * and no retry is needed. Inlined so the calling ISR does no call.
+ *
+ * @return Ticks Ticks since TimeBase_Init().
+ */
+static ALWAYS_INLINE Ticks TimeBase_NowFromISR()
+{
+	return g_TimeBaseTicks;
+}
+
+/**
+ * @brief Read the current instant at timer clock resolution.
+ *
+ * Interrupts are held off for the few cycles it takes to read the counter and
+ * the tick count together.
+ *
+ * @param stamp Pointer to the timestamp to fill.
+ */
+void TimeBase_Stamp(TimeStamp* stamp);
+
+/**
+ * @brief Correct the timebase for a crystal frequency error.
+ *
+ * @param centiPpm Crystal error in 0.01 ppm, positive when the crystal runs
+ *                 fast. Clamped to +/-TIMEBASE_TRIM_LIMIT; 0 disables the trim.
+ */
+void TimeBase_SetTrim(int16 centiPpm);
+
+/**
+ * @brief Read back the applied trim.
+ *
+ * @return int16 Crystal error in 0.01 ppm, as clamped by TimeBase_SetTrim().
+ */
+int16 TimeBase_Trim();
+
+#if TIMEBASE_HAS_CAPTURE
+/**
+ * @brief Timestamp ICP1 edges in hardware.
+ *
+ * Every captured edge is buffered and reported with EVENT_CAPTURE. The pin
+ * must already be configured as an input. Requires TimeBase_Init().
+ *
+ * @param edge Edge that triggers the capture.
+ */
+void TimeBase_Capture_Init(CaptureEdge edge);
+#endif
+
+/**
+ * @brief Take the oldest buffered capture.
+ *
+ * @param stamp Pointer to the timestamp to fill.
+ * @return uint8 TRUE if a capture was taken, FALSE if none is buffered.
+ */
+uint8 TimeBase_PopCapture(TimeStamp* stamp);
+
+/**
+ * @brief Timer clocks from one timestamp to a later one.
+ *
+ * On Timer1 a timer clock is one CPU cycle.
+ *
+ * @param from Earlier timestamp.
+ * @param to Later timestamp.
+ * @return uint32 Timer clocks between the two, saturated at 0xFFFFFFFF (about 268 s on Timer1).
+ */
+uint32 TimeBase_CyclesBetween(const TimeStamp* from, const TimeStamp* to);
+
+/**
+ * @brief Convert a tick count to hundredths of a second, rounding down.
+ *
+ * @param ticks Tick count (any value; no intermediate overflow).
+ * @return uint32 Hundredths of a second.
+ */
+uint32 TimeBase_Hundredths(Ticks ticks);
+
+#endif // TIME_BASE_H
@@ -1,5 +1,6 @@
 #include "Timers.h"
 #include "Led.h"
+#include <util/atomic.h>
 
 
 static void SetPreScalar(Timer timer,  TimerSetting preScalar);
@@ -131,6 +132,26 @@ void Timer1_CTC_Init(uint16 compareVal, TimerSetting preScalar)
     sei();                      // Enable interrupts
 }
 
+void Timer1_Capture_Init(CaptureEdge edge)
+{
+    cli();                      // Disable interrupts
+
+    SET(TCCR1B, ICNC1);         // Input capture noise canceler
+    if (edge == CAPTURE_RISING_EDGE)
+    {
+        SET(TCCR1B, ICES1);
+    }
+    else
+    {
+        CLEAR(TCCR1B, ICES1);
+    }
+
+    TIFR = (1 << ICF1);         // Discard a stale capture (plain write: SET would also clear other pending flags)
+    SET(TIMSK, TICIE1);         // Enable Timer1 Input Capture Interrupt
+
+    sei();                      // Enable interrupts
+}
+
 void Timer2_CTC_Init(uint8 compareVal, TimerSetting preScalar)
 {
     cli();                      // Disable interrupts
@@ -153,6 +174,66 @@ void Timer2_CTC_Init(uint8 compareVal, TimerSetting preScalar)
     sei();                      // Enable interrupts
 }
 
+void Timer2_Async_CTC_Init(uint8 compareVal, TimerSetting preScalar)
+{
+    cli();                      // Disable interrupts
+	Timer2_Pre = preScalar;		// store pre-scalar for resume function
+
+    // Timer2 interrupts off while the clock source changes
+    CLEAR(TIMSK, OCIE2);
+    CLEAR(TIMSK, TOIE2);
+
+    SET(ASSR, AS2);             // Clock Timer2 from the crystal on TOSC1/TOSC2
+
+    TCNT2 = 0;
+    OCR2 = compareVal;
+
+    // Configure CTC mode (WGM21:20 = 01)
+    CLEAR(TCCR2, WGM20);
+    SET(TCCR2, WGM21);
+    SetPreScalar(Timer2, preScalar);
+
+    // Writes cross into the asynchronous clock domain; wait until all three have landed
+    while (ASSR & ((1 << TCN2UB) | (1 << OCR2UB) | (1 << TCR2UB)))
+    {
+    }
+
+    TIFR = (1 << OCF2) | (1 << TOV2);  // Flags may have been corrupted by the switch
+    SET(TIMSK, OCIE2);      // Enable Timer2 Compare Match Interrupt
+
+    sei();                      // Enable interrupts
+}
+
+void Timer2_Toggle_Init(uint8 compareVal, TimerSetting preScalar)
+{
+	Timer2_Pre = preScalar;		// store pre-scalar for resume function
+
+    // No interrupts: the output compare unit drives the pin on its own
+    CLEAR(TIMSK, OCIE2);
+    CLEAR(TIMSK, TOIE2);
+
+    Timer2_OFF();
+    TCNT2 = 0;
+    OCR2 = compareVal;
+
+    // Configure CTC mode (WGM21:20 = 01), toggle OC2 on compare match (COM21:20 = 01)
+    CLEAR(TCCR2, WGM20);
+    SET(TCCR2, WGM21);
+    CLEAR(TCCR2, COM21);
+    SET(TCCR2, COM20);
+
+    SetPreScalar(Timer2, preScalar);
+}
+
+void Timer2_Toggle_Stop()
+{
+    Timer2_OFF();
+
+    // OC2 disconnected (COM21:20 = 00), the pin follows PORTD again
+    CLEAR(TCCR2, COM21);
+    CLEAR(TCCR2, COM20);
+}
+
 void Timer0_OFF()
 {
     // Stop Timer0 by clearing pre-scaler bits (CS02:00 = 0)
@@ -179,6 +260,18 @@ void Timer1_ON()
     SetPreScalar(Timer1, Timer1_Pre);
 }
 
+void Timer1_Restart()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        Timer1_OFF();
+        TCNT1 = 0;
+        SET(SFIOR, PSR10);      // Restart the prescaler phase (shared with Timer0); keeps ACME, PUD, ADTS
+        TIFR = (1 << OCF1A);    // Discard a compare match latched before the restart
+        SetPreScalar(Timer1, Timer1_Pre);
+    }
+}
+
 void Timer2_OFF()
 {
     // Stop Timer2 by clearing pre-scaler bits (CS22:20 = 0)
@@ -227,11 +320,11 @@ static void SetPreScalar(Timer timer,  TimerSetting preScalar)
             {
                 case NO_PRESCALAR:      CLEAR(TCCR2,CS22); CLEAR(TCCR2,CS21); SET(TCCR2,CS20); break;
                 case PRESCALAR_8:       CLEAR(TCCR2,CS22); SET(TCCR2,CS21); CLEAR(TCCR2,CS20); break;
-                case PRESCALAR_64:      CLEAR(TCCR2,CS22); SET(TCCR2,CS21); SET(TCCR2,CS20); break;
-                case PRESCALAR_256:     SET(TCCR2,CS22); CLEAR(TCCR2,CS21); CLEAR(TCCR2,CS20); break;
-                case PRESCALAR_1024:    SET(TCCR2,CS22); CLEAR(TCCR2,CS21); SET(TCCR2,CS20); break;
-                case EXT_FALLING_EDGE:  SET(TCCR2,CS22); SET(TCCR2,CS21); CLEAR(TCCR2,CS20); break;
-                case EXT_RISING_EDGE:   SET(TCCR2,CS22); SET(TCCR2,CS21); SET(TCCR2,CS20); break;
+                // Timer2 has its own table (CS22:0 = 011 is clk/32) and no external clock pin
+                case PRESCALAR_64:      SET(TCCR2,CS22); CLEAR(TCCR2,CS21); CLEAR(TCCR2,CS20); break;
+                case PRESCALAR_256:     SET(TCCR2,CS22); SET(TCCR2,CS21); CLEAR(TCCR2,CS20); break;
+                case PRESCALAR_1024:    SET(TCCR2,CS22); SET(TCCR2,CS21); SET(TCCR2,CS20); break;
+                default:                break;
             }
             break;
     }
@@ -69,6 +69,15 @@ typedef enum
 	INTERRUPT  /**< ISR-based operation */
 } TimerTechnique;
 
+/**
+ * @brief Timer1 input capture (ICP1) trigger edge.
+ */
+typedef enum
+{
+	CAPTURE_FALLING_EDGE, /**< Capture on a falling edge of ICP1 */
+	CAPTURE_RISING_EDGE   /**< Capture on a rising edge of ICP1 */
+} CaptureEdge;
+
 /**
  * @brief Initialize Timer0 in Normal mode.
  *
@@ -109,6 +118,17 @@ void Timer0_CTC_Init(uint8 compareVal, TimerSetting preScalar);
  */
 void Timer1_CTC_Init(uint16 compareVal, TimerSetting preScalar);
 
+/**
+ * @brief Enable the Timer1 input capture interrupt on ICP1 (PD6).
+ *
+ * The counter keeps its current mode and clock; ICR1 latches TCNT1 on every
+ * selected edge. The noise canceler is on, which delays the capture by a
+ * fixed 4 timer clocks.
+ *
+ * @param edge Edge that triggers the capture.
+ */
+void Timer1_Capture_Init(CaptureEdge edge);
+
 /**
  * @brief Initialize Timer2 in CTC (Compare Match) mode.
  *
@@ -117,6 +137,39 @@ void Timer1_CTC_Init(uint16 compareVal, TimerSetting preScalar);
  */
 void Timer2_CTC_Init(uint8 compareVal, TimerSetting preScalar);
 
+/**
+ * @brief Initialize Timer2 in CTC mode, clocked from a 32.768 kHz watch crystal.
+ *
+ * Follows the datasheet sequence for switching to the asynchronous clock:
+ * Timer2 interrupts off, AS2 set, registers written, then waits for the
+ * TCN2UB/OCR2UB/TCR2UB update busy flags before clearing the stale flags
+ * and enabling the compare match interrupt. The crystal needs up to a
+ * second to stabilize after power-up; counting starts when it does.
+ *
+ * Later writes to TCNT2, OCR2 or TCCR2 must wait for the matching busy flag.
+ *
+ * @param compareVal Value to compare against the counter.
+ * @param preScalar Timer prescaler setting.
+ */
+void Timer2_Async_CTC_Init(uint8 compareVal, TimerSetting preScalar);
+
+/**
+ * @brief Run Timer2 in CTC mode toggling OC2 (PD7) in hardware.
+ *
+ * OC2 toggles on every compare match, so it outputs a square wave of
+ * F_CPU / (2 * division * (compareVal + 1)) with no interrupt and no CPU
+ * time. Calling it again retunes the running output. PD7 must be an output.
+ *
+ * @param compareVal Value to compare against the counter (half period - 1).
+ * @param preScalar Timer prescaler setting.
+ */
+void Timer2_Toggle_Init(uint8 compareVal, TimerSetting preScalar);
+
+/**
+ * @brief Stop Timer2 and disconnect OC2, leaving PD7 to its PORTD level.
+ */
+void Timer2_Toggle_Stop();
+
 /**
  * @brief Disable Timer0 (stops counting).
  */
@@ -137,6 +190,15 @@ void Timer1_OFF();
  */
 void Timer1_ON();
 
+/**
+ * @brief Restart Timer1 from a clean phase.
+ *
+ * With interrupts held off: clears TCNT1, resets the prescaler (PSR10, which
+ * Timer0 shares) and discards a pending compare match A, so the next
+ * compare match comes exactly OCR1A + 1 timer clocks later.
+ */
+void Timer1_Restart();
+
 /**
  * @brief Disable Timer2 (stops counting).
  */
@@ -0,0 +1,168 @@
+/**
+ * @file Tone.c
+ * @brief Buzzer pattern player on Timer2 output compare and the scheduler.
+ */
+
+#include "Tone.h"
+#include <avr/pgmspace.h>
+
+const Note Tone_Alarm[] PROGMEM =
+{
+	{2000, 100}, {TONE_REST, 100}, {2000, 100}, {TONE_REST, 700}, TONE_END
+};
+
+const Note Tone_Chime[] PROGMEM =
+{
+	{1047, 120}, {1319, 120}, {1568, 240}, TONE_END
+};
+
+#if TONE_HARDWARE
+/**
+ * @brief Timer2 clock sources, finest first.
+ */
+static const struct
+{
+	TimerSetting preScalar;
+	uint16 division;
+} Scales[] =
+{
+	{NO_PRESCALAR, 1}, {PRESCALAR_8, 8}, {PRESCALAR_64, 64}, {PRESCALAR_256, 256}, {PRESCALAR_1024, 1024}
+};
+#endif
+
+/// Buzzer pin
+static Buzzer Sounder;
+
+/// Ends the current note
+static SoftTimer NoteTimer;
+
+/// Ends a repeating pattern
+static SoftTimer TimeoutTimer;
+
+/// First and current note of the pattern playing
+static const Note* Pattern;
+static const Note* Current;
+
+/**
+ * @brief Starts a tone, or silences the buzzer for TONE_REST.
+ *
+ * Picks the finest Timer2 clock whose 8-bit compare register can hold the
+ * half period; the compare value stays above 31, so the pitch is within
+ * 1.6% (about a quarter semitone) of the requested frequency.
+ */
+static void Sound(uint16 hz)
+{
+#if TONE_HARDWARE
+	if (hz == TONE_REST)
+	{
+		Timer2_Toggle_Stop();
+		return;
+	}
+
+	uint32 counts = (F_CPU / 2 + hz / 2) / hz;   // CPU cycles per half period
+	uint8 i = 0;
+	while (counts > 256UL * Scales[i].division && i < sizeof(Scales) / sizeof(Scales[0]) - 1)
+	{
+		i++;
+	}
+
+	uint32 top = (counts + Scales[i].division / 2) / Scales[i].division;
+	Timer2_Toggle_Init((uint8)((top > 256 ? 256 : top) - 1), Scales[i].preScalar);
+#else
+	if (hz == TONE_REST)
+	{
+		BuzzerOff(&Sounder);
+	}
+	else
+	{
+		BuzzerOn(&Sounder);
+	}
+#endif
+}
+
+/**
+ * @brief Sounds the current note and times it; wraps or stops at TONE_END.
+ */
+static void PlayNote()
+{
+	uint16 ms = pgm_read_word(&Current->ms);
+	if (ms == 0)
+	{
+		if (!SoftTimer_Active(&TimeoutTimer))
+		{
+			Tone_Stop();
+			return;
+		}
+		Current = Pattern;
+		ms = pgm_read_word(&Current->ms);
+	}
+
+	Sound(pgm_read_word(&Current->hz));
+	SoftTimer_Start(&NoteTimer, MS_TO_TICKS(ms), 0);
+}
+
+/**
+ * @brief NoteTimer callback: moves on to the next note.
+ */
+static void NextNote(void* context)
+{
+	Current++;
+	PlayNote();
+}
+
+/**
+ * @brief TimeoutTimer callback: ends a repeating pattern.
+ */
+static void Timeout(void* context)
+{
+	Tone_Stop();
+}
+
+/**
+ * @brief Configures the pin as a low output and prepares the timers.
+ */
+void Tone_Init(uint8 port, uint8 pin)
+{
+	Buzzer_Init(&Sounder, port, pin);
+	SoftTimer_Init(&NoteTimer, NextNote, NULL);
+	SoftTimer_Init(&TimeoutTimer, Timeout, NULL);
+	Pattern = NULL;
+}
+
+/**
+ * @brief Starts @p pattern from its first note.
+ */
+void Tone_Play(const Note* pattern, uint16 timeoutMs)
+{
+	Pattern = pattern;
+	Current = pattern;
+
+	if (timeoutMs)
+	{
+		SoftTimer_Start(&TimeoutTimer, MS_TO_TICKS(timeoutMs), 0);
+	}
+	else
+	{
+		SoftTimer_Cancel(&TimeoutTimer);
+	}
+	PlayNote();
+}
+
+/**
+ * @brief Stops both timers and the sound.
+ */
+void Tone_Stop()
+{
+	SoftTimer_Cancel(&NoteTimer);
+	SoftTimer_Cancel(&TimeoutTimer);
+	Sound(TONE_REST);
+	Pattern = NULL;
+}
+
+/**
+ * @brief Reports whether a note is being timed.
+ */
+uint8 Tone_Playing()
+{
+	return SoftTimer_Active(&NoteTimer);
+}
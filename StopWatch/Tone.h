@@ -0,0 +1,84 @@
+/**
+ * @file Tone.h
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Non-blocking buzzer tones and patterns.
+ *
+ * With the Timer1 timebase, Timer2 is free and generates each tone in
+ * hardware: CTC mode toggles OC2 (PD7) on compare match, so a note costs
+ * no CPU time per cycle, only one retune when it starts. A passive
+ * (magnetic or piezo) buzzer on OC2 then plays the pitch.
+ *
+ * With the Timer2 watch-crystal timebase there is no free timer with a
+ * free output compare pin (OC1A/OC1B drive the mode LEDs), so the buzzer
+ * pin is driven as a DC level instead: an active buzzer plays the rhythm
+ * of a pattern at its own pitch.
+ *
+ * Patterns are Note arrays in flash, sequenced by a scheduler SoftTimer,
+ * and stop by themselves at the end or after a timeout.
+ */
+
+#include "Buzzer.h"
+#include "Scheduler.h"
+
+#ifndef TONE_H
+#define TONE_H
+
+/** @brief TRUE when tones are generated by Timer2 on OC2. */
+#define TONE_HARDWARE (TIMEBASE_SOURCE == TIMEBASE_TIMER1)
+
+/** @brief Frequency of a silent note. */
+#define TONE_REST 0
+
+/** @brief Lowest tone Timer2 can generate (clk/1024, TOP = 255), Hz. */
+#define TONE_MIN_HZ 31
+
+/** @brief Pattern terminator. */
+#define TONE_END {0, 0}
+
+/**
+ * @brief One step of a pattern.
+ */
+typedef struct
+{
+	uint16 hz; /**< Tone frequency (TONE_MIN_HZ and up), TONE_REST for silence */
+	uint16 ms; /**< Duration, 0 only in TONE_END */
+} Note;
+
+/** @name Patterns (in flash) */
+///@{
+extern const Note Tone_Alarm[]; /**< Double beep with a pause, for looping */
+extern const Note Tone_Chime[]; /**< Rising three-note chime */
+///@}
+
+/**
+ * @brief Configure the buzzer pin (silent). Requires Scheduler_Init().
+ *
+ * @param port Port of the buzzer; 'D' with the Timer2 tone output.
+ * @param pin Pin of the buzzer; PD7 (OC2) with the Timer2 tone output.
+ */
+void Tone_Init(uint8 port, uint8 pin);
+
+/**
+ * @brief Start playing a pattern, replacing the one playing.
+ *
+ * @param pattern Note array in flash (PROGMEM) with at least one note,
+ *                ended by TONE_END.
+ * @param timeoutMs 0 to play the pattern once, otherwise the pattern
+ *                  repeats until @p timeoutMs milliseconds have passed.
+ */
+void Tone_Play(const Note* pattern, uint16 timeoutMs);
+
+/**
+ * @brief Silence the buzzer and drop the pattern.
+ */
+void Tone_Stop();
+
+/**
+ * @brief Check whether a pattern is playing.
+ *
+ * @return uint8 TRUE until the pattern ends, times out or is stopped.
+ */
+uint8 Tone_Playing();
+
+#endif // TONE_H
@@ -1,4 +1,25 @@
 #include "Application.h"
+#include "Calibration.h"
+#include "Clock.h"
+#include "Eeprom.h"
+#include "Persist.h"
+#include "Power.h"
+#include "Scheduler.h"
+
+/// Hold-to-repeat timing shared by all time adjustment buttons
+static const AutoRepeatConfig AdjustRepeatConfig =
+{
+	MS_TO_DEBOUNCE_TICKS(AUTOREPEAT_DELAY_MS),
+	MS_TO_DEBOUNCE_TICKS(AUTOREPEAT_PERIOD_MS),
+	MS_TO_DEBOUNCE_TICKS(AUTOREPEAT_MIN_PERIOD_MS),
+	AUTOREPEAT_ACCEL_STEPS
+};
+
+/// Pins the debouncer watches, see DEBOUNCE_PINS()
+static const PortSnapshot DebouncedPins =
+{
+	{ DEBOUNCE_PINS(0), DEBOUNCE_PINS(1), DEBOUNCE_PINS(2), DEBOUNCE_PINS(3) }
+};
 
 int main()
 {
@@ -42,9 +63,23 @@ int main()
 	PushButton SecondDecButton;
 	PushButton_Init(&SecondDecButton, SEC_DEC_BB_PORT, SEC_DEC_BB_PIN, SEC_DEC_BB_TYPE);
 
-	// Buzzer
-	Buzzer myBuzzer;
-	Buzzer_Init(&myBuzzer, BUZZER_PORT, BUZZER_PIN);
+	// Photogate start/stop input (timestamped by timer1 input capture)
+	PushButton Photogate;
+	PushButton_Init(&Photogate, PHOTOGATE_PORT, PHOTOGATE_PIN, PHOTOGATE_TYPE);
+
+	// Split input (timestamped by the display ISR into the lap buffer)
+	PushButton SplitButton;
+	PushButton_Init(&SplitButton, SPLIT_BB_PORT, SPLIT_BB_PIN, SPLIT_BB_TYPE);
+	Lap_Init();
+
+	// Hold-to-repeat for the time adjustment buttons
+	AutoRepeat HourIncRepeat, HourDecRepeat, MinuteIncRepeat, MinuteDecRepeat, SecondIncRepeat, SecondDecRepeat;
+	AutoRepeat_Init(&HourIncRepeat, &AdjustRepeatConfig);
+	AutoRepeat_Init(&HourDecRepeat, &AdjustRepeatConfig);
+	AutoRepeat_Init(&MinuteIncRepeat, &AdjustRepeatConfig);
+	AutoRepeat_Init(&MinuteDecRepeat, &AdjustRepeatConfig);
+	AutoRepeat_Init(&SecondIncRepeat, &AdjustRepeatConfig);
+	AutoRepeat_Init(&SecondDecRepeat, &AdjustRepeatConfig);
 
 	// Count up LED
 	Led CountUP;
@@ -59,109 +94,224 @@ int main()
 	{
 		SevenSegment_Init(&g_Mult_SevenSegment[i],SEVEN_SEGMENT_DATA_PORT, SEVEN_SEGMENT_DATA_PINS);
 	}
+	// display multiplexing, split sampling and button debouncing run from the timer0 interrupt
+	Debounce_Init(&DebouncedPins);
+	SevenSegmentDisplay_Init();
+
 	// external interrupts 0,1,2 initializations
 	INT0_Init(FALLING_EDGE);
 	INT1_Init(RISING_EDGE);
 	INT2_Init(FALLING_EDGE);
 
-	// timer1 initialization to count 1 second
-	Timer1_CTC_Init(COMPARE_MATCH_FOR_1SEC, PRESCALAR_1024);
+	// timer1 runs the timebase; the stopwatch value is derived from its timestamps
+	TimeBase_Init();
+
+	// EEPROM writes are queued and written out by the EE_RDY interrupt
+	Eeprom_Init();
+
+	// crystal trim: stored value, or (Timer1) a new measurement when mode is held at power-up
+	Calibration_Load();
+#if TIMEBASE_HAS_CAPTURE
+	TimeBase_Capture_Init(PHOTOGATE_EDGE);
+	if (ReadButton(&ModeButton) == PRESSED)
+	{
+		Calibration_Run();
+	}
+#endif
+	// lap history: find the end of the EEPROM log
+	LapLog_Init();
+	StopWatch_Init();
+
+	// software timers share the timebase tick; callbacks run from the loop below
+	Scheduler_Init();
+	Clock_Init();
+	Tone_Init(BUZZER_PORT, BUZZER_PIN);
+
+	// state saved before the last power-down: restored paused, or running after a power-fail save
+	Persist_Init();
+
+	// unused peripherals off, supply monitor armed if the board has one (POWER_FAIL_DETECT); the loop below sleeps whenever the event queue is empty
+	Power_Init();
+
+	// debounced snapshot of all input pins, taken when the buttons need service
+	DebouncedSnapshot inputs;
+	uint8 buttonsHeld = FALSE;
+
+	// mode button: debounce ticks held since its press, and the digits it selected
+	uint16 modeHeld = 0;
+	uint8 clockShown = FALSE;
+
+	// outputs are only written when what they show changes
+	uint8 shownMode = 0xFF;
+	uint8 alarmed = FALSE;
+#if TIMEBASE_HAS_CAPTURE
+	uint32 gateCycles = 0;
+#endif
 
 	while(1)
 	{
-		// 1. put the visual input first
-		SevenSegmentUpdate();
-		UpdateCountLEDs(&CountUP, &CountDOWN);
-
-	    // 2. Handle Mode Toggle
-	    if (ReadButton(&ModeButton) == PRESSED)
-	    {
-	    	ToggleStopWatchMode;
-	        while(ReadButton(&ModeButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 3. Handle Time Adjustment Buttons
-	    // 3.1 Hours Increment
-	    if (ReadButton(&HourIncButton) == PRESSED)
-	    {
-	        IncHour();
-	        while(ReadButton(&HourIncButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 3.2 Hours Decrement
-	    if (ReadButton(&HourDecButton) == PRESSED)
-	    {
-	        DecHour();
-	        while(ReadButton(&HourDecButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 3.3 Minutes Increment
-	    if (ReadButton(&MinuteIncButton) == PRESSED)
-	    {
-	        IncMin();
-	        while(ReadButton(&MinuteIncButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 3.4 Minutes Decrement
-	    if (ReadButton(&MinuteDecButton) == PRESSED)
-	    {
-	        DecMin();
-	        while(ReadButton(&MinuteDecButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 3.5 Seconds Increment
-	    if (ReadButton(&SecondIncButton) == PRESSED)
-	    {
-	        IncSec();
-	        while(ReadButton(&SecondIncButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 3.6 Seconds Decrement
-	    if (ReadButton(&SecondDecButton) == PRESSED)
-	    {
-	        DecSec();
-	        while(ReadButton(&SecondDecButton) == PRESSED)
-	        {
-	    		SevenSegmentUpdate();
-	    		UpdateCountLEDs(&CountUP, &CountDOWN);
-	        }
-	    }
-
-	    // 4. Handle Buzzer (e.g., when count-down reaches 00:00:00)
-	    if (g_mode == DECREMENTAL_MODE &&
-	    		g_SevenSeg_time.Hour == 0 &&
-				g_SevenSeg_time.Min == 0 &&
-				g_SevenSeg_time.Sec == 0)
-	    {
-	        BuzzerOn(&myBuzzer);
-	    }
-	    else
-	    {
-	    	BuzzerOff(&myBuzzer);
-	    }
+		// 1. Drain the events queued by the ISRs, in order
+		uint8 inputChanged = FALSE;
+		Event event;
+		while (EventQueue_Pop(&event))
+		{
+			if (event.type == EVENT_BUTTON_EDGE)
+			{
+				inputChanged = TRUE;
+			}
+			else
+			{
+				StopWatch_HandleEvent(&event);
+				Persist_HandleEvent(&event);
+			}
+		}
+
+		// 2. put the visual input first (digits are multiplexed by the timer0 ISR)
+		Scheduler_Run();
+		StopWatch_Refresh();
+		if (g_mode != shownMode)
+		{
+			shownMode = g_mode;
+			UpdateCountLEDs();
+		}
+
+		// 3. Buttons only need service on a new edge or while one is held (auto-repeat)
+		if (inputChanged || buttonsHeld)
+		{
+			TakeDebouncedSnapshot(&inputs);
+			SampleDebouncedButton(&ModeButton, &inputs);
+			SampleDebouncedButton(&HourIncButton, &inputs);
+			SampleDebouncedButton(&HourDecButton, &inputs);
+			SampleDebouncedButton(&MinuteIncButton, &inputs);
+			SampleDebouncedButton(&MinuteDecButton, &inputs);
+			SampleDebouncedButton(&SecondIncButton, &inputs);
+			SampleDebouncedButton(&SecondDecButton, &inputs);
+
+			uint8 adjustHeld = HourIncButton.state | HourDecButton.state |
+			                   MinuteIncButton.state | MinuteDecButton.state |
+			                   SecondIncButton.state | SecondDecButton.state;
+			buttonsHeld = adjustHeld | ModeButton.state;
+
+			// 3.1 Handle Mode Button: a long press switches to or from the clock, a short one toggles the direction
+			if (ModeButton.edges & BUTTON_PRESS_EDGE)
+			{
+				// The ticks of this snapshot were spent before the press, as in AutoRepeat_Update()
+				modeHeld = 0;
+			}
+			else if (ModeButton.state == PRESSED && modeHeld < MS_TO_DEBOUNCE_TICKS(CLOCK_VIEW_HOLD_MS))
+			{
+				modeHeld += inputs.ticks;
+				if (modeHeld >= MS_TO_DEBOUNCE_TICKS(CLOCK_VIEW_HOLD_MS))
+				{
+					clockShown = !clockShown;
+					StopWatch_ShowClock(clockShown);
+				}
+			}
+			if ((ModeButton.edges & BUTTON_RELEASE_EDGE) && modeHeld < MS_TO_DEBOUNCE_TICKS(CLOCK_VIEW_HOLD_MS) && !clockShown)
+			{
+				StopWatch_ToggleMode();
+				Persist_Save();
+			}
+
+			// 3.2 Handle Time Adjustment Buttons (step on press, then auto-repeat while held); they set the clock while it is shown
+			for (uint8 steps = AutoRepeat_Update(&HourIncRepeat, &HourIncButton, inputs.ticks); steps; steps--)
+			{
+				if (clockShown)
+				{
+					Clock_Adjust(3600);
+				}
+				else
+				{
+					IncHour();
+				}
+			}
+			for (uint8 steps = AutoRepeat_Update(&HourDecRepeat, &HourDecButton, inputs.ticks); steps; steps--)
+			{
+				if (clockShown)
+				{
+					Clock_Adjust(-3600);
+				}
+				else
+				{
+					DecHour();
+				}
+			}
+			for (uint8 steps = AutoRepeat_Update(&MinuteIncRepeat, &MinuteIncButton, inputs.ticks); steps; steps--)
+			{
+				if (clockShown)
+				{
+					Clock_Adjust(60);
+				}
+				else
+				{
+					IncMin();
+				}
+			}
+			for (uint8 steps = AutoRepeat_Update(&MinuteDecRepeat, &MinuteDecButton, inputs.ticks); steps; steps--)
+			{
+				if (clockShown)
+				{
+					Clock_Adjust(-60);
+				}
+				else
+				{
+					DecMin();
+				}
+			}
+			for (uint8 steps = AutoRepeat_Update(&SecondIncRepeat, &SecondIncButton, inputs.ticks); steps; steps--)
+			{
+				if (clockShown)
+				{
+					Clock_Adjust(1);
+				}
+				else
+				{
+					IncSec();
+				}
+			}
+			for (uint8 steps = AutoRepeat_Update(&SecondDecRepeat, &SecondDecButton, inputs.ticks); steps; steps--)
+			{
+				if (clockShown)
+				{
+					Clock_Adjust(-1);
+				}
+				else
+				{
+					DecSec();
+				}
+			}
+
+			// 3.3 Adjustments are saved once the buttons have been left alone for a while
+			if (adjustHeld && !clockShown)
+			{
+				Persist_Changed();
+			}
+		}
+
+		// 4. Alarm when the count-down reaches 00:00:00, chime when the photogate stops
+		uint8 expired = StopWatch_Expired();
+		if (expired != alarmed)
+		{
+			alarmed = expired;
+			if (expired)
+			{
+				Tone_Play(Tone_Alarm, ALARM_TIMEOUT_MS);
+			}
+			else
+			{
+				Tone_Stop();
+			}
+		}
+#if TIMEBASE_HAS_CAPTURE
+		if (StopWatch_GateCycles() != gateCycles)
+		{
+			gateCycles = StopWatch_GateCycles();
+			Tone_Play(Tone_Chime, 0);
+		}
+#endif
+
+		// 5. Nothing left to do until the next interrupt queues an event
+		Power_Serviced();
+		Power_Idle();
 	}
 }
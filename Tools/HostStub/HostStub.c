@@ -0,0 +1,25 @@
+/**
+ * @file HostStub.c
+ * @brief Host stand-ins for the ATmega32 registers and the avr-libc EEPROM routines.
+ *
+ * With the headers in this directory on the include path, the firmware
+ * sources compile with a host C compiler: every I/O register is a byte of
+ * __regs, and EEMEM objects are ordinary variables, so the EEPROM routines
+ * are plain memory accesses. Nothing runs on its own; a host test calls the
+ * ISRs and sets the input registers itself.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+volatile uint8_t __regs[0x60];
+
+uint8_t eeprom_read_byte(const uint8_t* p) { return *p; }
+void eeprom_write_byte(uint8_t* p, uint8_t v) { *p = v; }
+void eeprom_update_byte(uint8_t* p, uint8_t v) { if (*p != v) *p = v; }
+uint16_t eeprom_read_word(const uint16_t* p) { return *p; }
+void eeprom_update_word(uint16_t* p, uint16_t v) { *p = v; }
+void eeprom_read_block(void* d, const void* s, size_t n) { memcpy(d, s, n); }
+void eeprom_update_block(const void* s, void* d, size_t n) { memcpy(d, s, n); }
+void eeprom_write_block(const void* s, void* d, size_t n) { memcpy(d, s, n); }
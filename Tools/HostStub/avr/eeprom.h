@@ -0,0 +1,17 @@
+/* Host stand-in for <avr/eeprom.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_EE_H
+#define STUB_EE_H
+#include <stdint.h>
+#include <stddef.h>
+#define EEMEM __attribute__((section("eeprom_stub")))
+uint8_t eeprom_read_byte(const uint8_t*);
+void eeprom_write_byte(uint8_t*, uint8_t);
+void eeprom_update_byte(uint8_t*, uint8_t);
+uint16_t eeprom_read_word(const uint16_t*);
+void eeprom_update_word(uint16_t*, uint16_t);
+void eeprom_read_block(void*, const void*, size_t);
+void eeprom_update_block(const void*, void*, size_t);
+void eeprom_write_block(const void*, void*, size_t);
+#define eeprom_is_ready() 1
+#define eeprom_busy_wait() do{}while(0)
+#endif
@@ -0,0 +1,10 @@
+/* Host stand-in for <avr/interrupt.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_INT_H
+#define STUB_INT_H
+#define ISR(v, ...) void v(void); void v(void)
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define reti()
+#define sei() ((void)0)
+#define cli() ((void)0)
+#endif
@@ -0,0 +1,176 @@
+/* Host stand-in for <avr/io.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_AVR_IO_H
+#define STUB_AVR_IO_H
+#include <stdint.h>
+extern volatile uint8_t __regs[0x60];
+#define _SFR_IO8(a) (*(volatile uint8_t*)&__regs[(a)+0x20])
+#define _SFR_IO16(a) (*(volatile uint16_t*)&__regs[(a)+0x20])
+#define _SFR_MEM8(a) (*(volatile uint8_t*)&__regs[(a)])
+#define _BV(b) (1<<(b))
+#define TWBR _SFR_IO8(0x00)
+#define ADCSRA _SFR_IO8(0x06)
+#define ADEN 7
+#define ACSR _SFR_IO8(0x08)
+#define ACD 7
+#define ACBG 6
+#define ACO 5
+#define ACI 4
+#define ACIE 3
+#define ACIC 2
+#define ACIS1 1
+#define ACIS0 0
+#define PIND _SFR_IO8(0x10)
+#define DDRD _SFR_IO8(0x11)
+#define PORTD _SFR_IO8(0x12)
+#define PINC _SFR_IO8(0x13)
+#define DDRC _SFR_IO8(0x14)
+#define PORTC _SFR_IO8(0x15)
+#define PINB _SFR_IO8(0x16)
+#define DDRB _SFR_IO8(0x17)
+#define PORTB _SFR_IO8(0x18)
+#define PINA _SFR_IO8(0x19)
+#define DDRA _SFR_IO8(0x1A)
+#define PORTA _SFR_IO8(0x1B)
+#define EECR _SFR_IO8(0x1C)
+#define EERIE 3
+#define EEMWE 2
+#define EEWE 1
+#define EERE 0
+#define EEDR _SFR_IO8(0x1D)
+#define EEAR _SFR_IO16(0x1E)
+#define EEARL _SFR_IO8(0x1E)
+#define E2END 0x3FF
+#define ASSR _SFR_IO8(0x22)
+#define AS2 3
+#define TCN2UB 2
+#define OCR2UB 1
+#define TCR2UB 0
+#define OCR2 _SFR_IO8(0x23)
+#define TCNT2 _SFR_IO8(0x24)
+#define TCCR2 _SFR_IO8(0x25)
+#define FOC2 7
+#define WGM20 6
+#define COM21 5
+#define COM20 4
+#define WGM21 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+#define ICR1 _SFR_IO16(0x26)
+#define OCR1B _SFR_IO16(0x28)
+#define OCR1A _SFR_IO16(0x2A)
+#define TCNT1 _SFR_IO16(0x2C)
+#define TCCR1B _SFR_IO8(0x2E)
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define TCCR1A _SFR_IO8(0x2F)
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define FOC1A 3
+#define FOC1B 2
+#define WGM11 1
+#define WGM10 0
+#define SFIOR _SFR_IO8(0x30)
+#define ACME 3
+#define PSR2 1
+#define PSR10 0
+#define OSCCAL _SFR_IO8(0x31)
+#define TCNT0 _SFR_IO8(0x32)
+#define TCCR0 _SFR_IO8(0x33)
+#define FOC0 7
+#define WGM00 6
+#define COM01 5
+#define COM00 4
+#define WGM01 3
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define MCUCSR _SFR_IO8(0x34)
+#define ISC2 6
+#define BORF 2
+#define PORF 0
+#define MCUCR _SFR_IO8(0x35)
+#define SE 7
+#define SM2 6
+#define SM1 5
+#define SM0 4
+#define ISC11 3
+#define ISC10 2
+#define ISC01 1
+#define ISC00 0
+#define TIFR _SFR_IO8(0x38)
+#define OCF2 7
+#define TOV2 6
+#define ICF1 5
+#define OCF1A 4
+#define OCF1B 3
+#define TOV1 2
+#define OCF0 1
+#define TOV0 0
+#define TIMSK _SFR_IO8(0x39)
+#define OCIE2 7
+#define TOIE2 6
+#define TICIE1 5
+#define OCIE1A 4
+#define OCIE1B 3
+#define TOIE1 2
+#define OCIE0 1
+#define TOIE0 0
+#define GIFR _SFR_IO8(0x3A)
+#define INTF1 7
+#define INTF0 6
+#define INTF2 5
+#define GICR _SFR_IO8(0x3B)
+#define INT1 7
+#define INT0 6
+#define INT2 5
+#define OCR0 _SFR_IO8(0x3C)
+#define SREG _SFR_IO8(0x3F)
+#define SPCR _SFR_IO8(0x0D)
+#define UCSRB _SFR_IO8(0x0A)
+#define TWCR _SFR_IO8(0x36)
+#define ADMUX _SFR_IO8(0x07)
+#define SPMCR _SFR_IO8(0x37)
+#define WDTCR _SFR_IO8(0x21)
+#define JTD 7
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define RAMEND 0x85F
+#endif
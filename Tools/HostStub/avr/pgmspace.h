@@ -0,0 +1,8 @@
+/* Host stand-in for <avr/pgmspace.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_PGM_H
+#define STUB_PGM_H
+#include <stdint.h>
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#endif
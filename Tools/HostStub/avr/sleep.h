@@ -0,0 +1,15 @@
+/* Host stand-in for <avr/sleep.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_SLEEP_H
+#define STUB_SLEEP_H
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC 1
+#define SLEEP_MODE_PWR_DOWN 2
+#define SLEEP_MODE_PWR_SAVE 3
+#define SLEEP_MODE_STANDBY 6
+#define SLEEP_MODE_EXT_STANDBY 7
+#define set_sleep_mode(m) ((void)(m))
+#define sleep_enable() ((void)0)
+#define sleep_disable() ((void)0)
+#define sleep_cpu() ((void)0)
+#define sleep_mode() ((void)0)
+#endif
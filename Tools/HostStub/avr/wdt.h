@@ -0,0 +1,8 @@
+/* Host stand-in for <avr/wdt.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_WDT_H
+#define STUB_WDT_H
+#define WDTO_15MS 0
+static inline void wdt_enable(int x){(void)x;}
+static inline void wdt_disable(void){}
+static inline void wdt_reset(void){}
+#endif
@@ -0,0 +1,7 @@
+/* Host stand-in for <util/atomic.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_ATOMIC_H
+#define STUB_ATOMIC_H
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(x) for (int __i = 1; __i; __i = 0)
+#endif
@@ -0,0 +1,7 @@
+/* Host stand-in for <util/crc16.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_CRC16_H
+#define STUB_CRC16_H
+#include <stdint.h>
+static inline uint8_t _crc8_ccitt_update(uint8_t inCrc, uint8_t inData)
+{ uint8_t data = inCrc ^ inData; for (uint8_t i = 0; i < 8; i++) { if (data & 0x80) { data <<= 1; data ^= 0x07; } else data <<= 1; } return data; }
+#endif
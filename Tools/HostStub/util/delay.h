@@ -0,0 +1,6 @@
+/* Host stand-in for <util/delay.h> of avr-libc, just enough to compile the firmware (see HostStub.c). */
+#ifndef STUB_DELAY_H
+#define STUB_DELAY_H
+static inline void _delay_ms(double x){(void)x;}
+static inline void _delay_us(double x){(void)x;}
+#endif
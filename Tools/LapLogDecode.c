@@ -0,0 +1,163 @@
+/**
+ * @file LapLogDecode.c
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Host tool: prints the laps stored in an EEPROM dump.
+ *
+ * Build with any host C compiler and run on a raw EEPROM image:
+ *
+ *     cc -o LapLogDecode Tools/LapLogDecode.c
+ *     avrdude -p m32 -c usbasp -U eeprom:r:eeprom.bin:r
+ *     ./LapLogDecode eeprom.bin [offset]
+ *
+ * offset is the address of LapLogImage in the .map file; without it the
+ * first valid session header in the image is taken as the start of the log.
+ * The format is described in StopWatch/LapLogFormat.h.
+ */
+
+#include "../StopWatch/LapLogFormat.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/** @brief Largest image accepted (the ATmega32 has 1 KB of EEPROM). */
+#define IMAGE_MAX 4096
+
+/**
+ * @brief CRC-8/CCITT (polynomial 0x07), as _crc8_ccitt_update() of avr-libc.
+ */
+static unsigned char Crc8(const unsigned char* data, int length)
+{
+	unsigned char crc = 0;
+	for (int i = 0; i < length; i++)
+	{
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x80) ? (unsigned char)((crc << 1) ^ 0x07) : (unsigned char)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/**
+ * @brief Checks for a valid session header at @p offset.
+ */
+static int IsHeader(const unsigned char* image, long size, long offset)
+{
+	return offset + LAPLOG_HEADER_SIZE <= size &&
+	       image[offset] == LAPLOG_HEADER &&
+	       image[offset + 1] == LAPLOG_VERSION &&
+	       image[offset + 8] == Crc8(&image[offset + 1], LAPLOG_HEADER_SIZE - 2);
+}
+
+/**
+ * @brief Prints a value in hundredths as [-]HH:MM:SS.hh.
+ */
+static void PrintTime(long hundredths)
+{
+	const char* sign = "";
+	if (hundredths < 0)
+	{
+		sign = "-";
+		hundredths = -hundredths;
+	}
+	printf("%s%02ld:%02ld:%02ld.%02ld", sign, hundredths / 360000, (hundredths / 6000) % 60,
+	       (hundredths / 100) % 60, hundredths % 100);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || argc > 3)
+	{
+		fprintf(stderr, "usage: %s eeprom.bin [offset]\n", argv[0]);
+		return 2;
+	}
+
+	FILE* file = fopen(argv[1], "rb");
+	if (!file)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+	static unsigned char image[IMAGE_MAX];
+	long size = (long)fread(image, 1, sizeof(image), file);
+	fclose(file);
+
+	long offset = 0;
+	if (argc == 3)
+	{
+		offset = strtol(argv[2], NULL, 0);
+	}
+	else
+	{
+		while (offset < size && !IsHeader(image, size, offset))
+		{
+			offset++;
+		}
+	}
+	if (offset >= size || !IsHeader(image, size, offset))
+	{
+		fprintf(stderr, "no lap log session found\n");
+		return 1;
+	}
+
+	long split = 0;
+	long lap = 0;
+	int number = 0;
+
+	while (offset < size)
+	{
+		unsigned char lead = image[offset];
+
+		if (lead == LAPLOG_HEADER)
+		{
+			if (!IsHeader(image, size, offset))
+			{
+				fprintf(stderr, "corrupt session header at 0x%03lx\n", offset);
+				break;
+			}
+			const unsigned char* header = &image[offset];
+			unsigned session = header[2] | (header[3] << 8);
+			split = (long)(header[4] | ((unsigned long)header[5] << 8) |
+			               ((unsigned long)header[6] << 16) | ((unsigned long)header[7] << 24));
+			lap = 0;
+			number = 0;
+
+			printf("Session %u, from ", session);
+			PrintTime(split);
+			printf("\n");
+			offset += LAPLOG_HEADER_SIZE;
+			continue;
+		}
+		if (lead >= LAPLOG_FIRST_RESERVED)
+		{
+			break; // LAPLOG_END or a torn entry
+		}
+
+		int length = LAPLOG_RECORD_LENGTH(lead);
+		if (offset + length > size)
+		{
+			break;
+		}
+
+		// Payload bits of the lead byte, then the following bytes
+		unsigned long value = lead & (0x7F >> (length - 1));
+		for (int i = 1; i < length; i++)
+		{
+			value = (value << 8) | image[offset + i];
+		}
+		offset += length;
+
+		lap += LAPLOG_UNZIGZAG(value);
+		split += lap;
+		number++;
+
+		printf("  Lap %3d  ", number);
+		PrintTime(lap < 0 ? -lap : lap);
+		printf("  split ");
+		PrintTime(split);
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file TimeCoreTest.c
+ * @author Seif
+ * @date 2025-06-16
+ * @brief Host test: the stopwatch time core against the original binary HH:MM:SS functions.
+ *
+ * The stopwatch once kept binary Hour/Min/Sec fields and stepped them with
+ * carry cascades. It now keeps a tick count and renders it as packed BCD.
+ * This test runs the firmware sources on the host (register stand-ins in
+ * Tools/HostStub) and compares them with a copy of the original functions:
+ * - each of IncHour/DecHour/IncMin/DecMin/IncSec/DecSec from every
+ *   HH:MM:SS, clamps at 99:59:59 and 00:00:00 included;
+ * - counting up and down through the timebase ISR, into both clamps.
+ *
+ * Build and run from the repository root:
+ *
+ *     cc -std=gnu99 -fshort-enums -funsigned-char -DF_CPU=16000000UL \
+ *        -ITools/HostStub -IStopWatch -o TimeCoreTest Tools/TimeCoreTest.c \
+ *        Tools/HostStub/HostStub.c $(ls StopWatch/*.c | grep -v main.c)
+ *     ./TimeCoreTest
+ *
+ * Prints the number of cases and exits with 0 when all of them match.
+ */
+
+#include "Application.h"
+#include "Eeprom.h"
+#include <stdio.h>
+
+void TIMER1_COMPA_vect(void);
+
+/** @brief Reference time, binary fields as in the original Time struct. */
+static struct
+{
+	uint8 Hour;
+	uint8 Min;
+	uint8 Sec;
+} Reference;
+
+/** @name Original binary functions */
+///@{
+static void RefIncHour()
+{
+	if (Reference.Hour == 99)
+	{
+		Reference.Min = 59;
+		Reference.Sec = 59;
+	}
+	else
+	{
+		Reference.Hour++;
+	}
+}
+
+static void RefDecHour()
+{
+	if (Reference.Hour == 0)
+	{
+		Reference.Min = 0;
+		Reference.Sec = 0;
+	}
+	else
+	{
+		Reference.Hour--;
+	}
+}
+
+static void RefIncMin()
+{
+	if (Reference.Min == 59)
+	{
+		Reference.Min = 0;
+		RefIncHour();
+	}
+	else
+	{
+		Reference.Min++;
+	}
+}
+
+static void RefDecMin()
+{
+	if (Reference.Min == 0)
+	{
+		Reference.Min = 59;
+		RefDecHour();
+	}
+	else
+	{
+		Reference.Min--;
+	}
+}
+
+static void RefIncSec()
+{
+	if (Reference.Sec == 59)
+	{
+		Reference.Sec = 0;
+		RefIncMin();
+	}
+	else
+	{
+		Reference.Sec++;
+	}
+}
+
+static void RefDecSec()
+{
+	if (Reference.Sec == 0)
+	{
+		Reference.Sec = 59;
+		RefDecMin();
+	}
+	else
+	{
+		Reference.Sec--;
+	}
+}
+///@}
+
+/**
+ * @brief Advances the timebase by one second and drops the events it queued.
+ */
+static void RunSecond()
+{
+	for (uint16 i = 0; i < TIMEBASE_HZ; i++)
+	{
+		TIMER1_COMPA_vect();
+	}
+
+	Event event;
+	while (EventQueue_Pop(&event))
+	{
+	}
+}
+
+/**
+ * @brief Compares the stopwatch time with the reference.
+ */
+static uint8 Matches()
+{
+	Time time;
+	TakeTimeSnapshot(&time);
+
+	return time.Hour == BIN_TO_BCD(Reference.Hour) &&
+	       time.Min == BIN_TO_BCD(Reference.Min) &&
+	       time.Sec == BIN_TO_BCD(Reference.Sec);
+}
+
+/**
+ * @brief Sets both implementations to the same time.
+ */
+static void SetBoth(uint8 hour, uint8 min, uint8 sec, uint8 mode, uint8 running)
+{
+	StopWatchState state;
+	state.value = ((Ticks)hour * 3600 + min * 60 + sec) * TIMEBASE_HZ;
+	state.mode = mode;
+	state.running = running;
+	StopWatch_SetState(&state);
+
+	Reference.Hour = hour;
+	Reference.Min = min;
+	Reference.Sec = sec;
+}
+
+int main()
+{
+	void (*const reference[])(void) = { RefIncHour, RefDecHour, RefIncMin, RefDecMin, RefIncSec, RefDecSec };
+	void (*const firmware[])(void) = { IncHour, DecHour, IncMin, DecMin, IncSec, DecSec };
+	uint32 cases = 0;
+
+	Eeprom_Init();
+	TimeBase_Init();
+	Lap_Init();
+	StopWatch_Init();
+
+	// Every adjustment from every time, paused
+	for (uint8 hour = 0; hour < 100; hour++)
+	{
+		for (uint8 min = 0; min < 60; min++)
+		{
+			for (uint8 sec = 0; sec < 60; sec++)
+			{
+				for (uint8 op = 0; op < 6; op++)
+				{
+					SetBoth(hour, min, sec, INCREMENTAL_MODE, FALSE);
+					reference[op]();
+					firmware[op]();
+					if (!Matches())
+					{
+						printf("adjust %02u:%02u:%02u, op %u: mismatch\n", hour, min, sec, op);
+						return 1;
+					}
+					cases++;
+				}
+			}
+		}
+	}
+
+	// Counting up into the clamp at 99:59:59
+	SetBoth(99, 58, 0, INCREMENTAL_MODE, TRUE);
+	for (uint8 i = 0; i < 70; i++)
+	{
+		RunSecond();
+		if (Reference.Hour != 99 || Reference.Min != 59 || Reference.Sec != 59)
+		{
+			RefIncSec();
+		}
+		if (!Matches())
+		{
+			printf("count up, second %u: mismatch\n", i);
+			return 1;
+		}
+		cases++;
+	}
+
+	// Counting down into the clamp at 00:00:00, across hour and minute borrows
+	SetBoth(1, 0, 5, DECREMENTAL_MODE, TRUE);
+	for (uint16 i = 0; i < 3620; i++)
+	{
+		RunSecond();
+		if (Reference.Hour || Reference.Min || Reference.Sec)
+		{
+			RefDecSec();
+		}
+		if (!Matches())
+		{
+			printf("count down, second %u: mismatch\n", i);
+			return 1;
+		}
+		cases++;
+	}
+
+	printf("%lu cases, all equal\n", (unsigned long)cases);
+	return 0;
+}